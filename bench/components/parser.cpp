@@ -0,0 +1,53 @@
+#include <chrono>
+#include <cstdio>
+
+#include "components/parser.cpp"
+#include "components/types.hpp"
+
+using namespace polybar;
+using clock_type = std::chrono::steady_clock;
+
+/**
+ * Repeat given markup until the input is at least `size` bytes
+ */
+string repeat(const string& markup, size_t size) {
+  string data;
+  while (data.size() < size) {
+    data += markup;
+  }
+  return data;
+}
+
+/**
+ * Parse the input `iterations` times and report the mean cost per KB
+ */
+void run(const char* name, const string& data, size_t iterations) {
+  bar_settings bar{};
+  display_list output;
+  auto p = parser::make();
+
+  auto start = clock_type::now();
+  for (size_t i = 0; i < iterations; i++) {
+    output.clear();
+    p->parse(bar, data, output);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+
+  double kb{data.size() / 1024.0};
+  std::printf("%-12s %8zu bytes %8zu cmds %10.1f ns/KB\n", name, data.size(), output.size(),
+      elapsed / static_cast<double>(iterations) / kb);
+}
+
+int main(int argc, char** argv) {
+  size_t iterations{argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000UL};
+
+  for (size_t size : {1024UL, 16 * 1024UL, 256 * 1024UL}) {
+    std::printf("--- %zu KB\n", size / 1024);
+    run("text", repeat("Lorem ipsum dolor sit amet, consectetur adipiscing elit. ", size), iterations);
+    run("colors", repeat("%{F#ff00ff B#aa112233 u#f00 +u}label%{-u B- F-} ", size), iterations);
+    run("workspaces", repeat("%{A1:i3-msg workspace 1:}%{A3:i3-msg move 1:}%{T2 O4}1%{O4 T-}%{A}%{A}", size),
+        iterations);
+  }
+
+  return 0;
+}
@@ -0,0 +1,188 @@
+#include <xcb/xcb_aux.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#include "components/bar.hpp"
+#include "components/config.hpp"
+#include "components/logger.hpp"
+#include "components/parser.hpp"
+#include "components/renderer.hpp"
+#include "components/types.hpp"
+#include "x11/connection.hpp"
+
+using namespace polybar;
+using clock_type = std::chrono::steady_clock;
+using std::chrono::nanoseconds;
+
+/**
+ * Number of heap allocations made by the process
+ */
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+  g_allocations++;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+/**
+ * Accumulated cost of one step of the pipeline
+ */
+struct phase {
+  const char* name;
+  nanoseconds time{0};
+  size_t allocations{0};
+  bool counted{true};
+};
+
+/**
+ * Read the frames written by `polybar --record`
+ */
+vector<string> load_frames(const char* path) {
+  std::ifstream in(path);
+  vector<string> frames;
+  string line;
+  while (std::getline(in, line)) {
+    if (!line.empty()) {
+      frames.emplace_back(move(line));
+    }
+  }
+  return frames;
+}
+
+/**
+ * Replay the frames through given renderer and print the cost of each phase
+ *
+ * When drawing to an X window, the time the server takes to process
+ * the frame is measured with a round trip after each frame
+ */
+void replay(renderer& r, const bar_settings& settings, const vector<string>& frames, size_t iterations, bool x11) {
+  auto p = parser::make();
+
+  phase parse{"parse"};
+  phase shape{"shape", nanoseconds{0}, 0, false};
+  phase paint{"paint"};
+  phase flush{"flush"};
+  phase sync{"sync", nanoseconds{0}, 0, false};
+
+  display_list commands;
+
+  for (size_t i = 0; i < iterations; i++) {
+    for (const auto& frame : frames) {
+      commands.clear();
+
+      auto t0 = clock_type::now();
+      size_t a0{g_allocations};
+      p->parse(settings, frame, commands);
+
+      auto t1 = clock_type::now();
+      size_t a1{g_allocations};
+      auto shaped = r.shaping_time();
+      r.begin(settings.inner_area());
+      r.render(commands);
+
+      auto t2 = clock_type::now();
+      size_t a2{g_allocations};
+      shaped = r.shaping_time() - shaped;
+      r.end();
+
+      auto t3 = clock_type::now();
+      size_t a3{g_allocations};
+
+      if (x11) {
+        xcb_aux_sync(connection::make());
+      }
+
+      auto t4 = clock_type::now();
+
+      parse.time += t1 - t0;
+      parse.allocations += a1 - a0;
+      shape.time += shaped;
+      paint.time += t2 - t1 - shaped;
+      paint.allocations += a2 - a1;
+      flush.time += t3 - t2;
+      flush.allocations += a3 - a2;
+      sync.time += t4 - t3;
+    }
+  }
+
+  // Shaping happens while painting, so its allocations are included there
+  double count{static_cast<double>(frames.size() * iterations)};
+  std::printf("%zu frames x %zu iterations\n", frames.size(), iterations);
+
+  vector<phase> phases{parse, shape, paint, flush};
+  if (x11) {
+    phases.emplace_back(sync);
+  }
+
+  for (const auto& ph : phases) {
+    if (ph.counted) {
+      std::printf("%-6s %10.2f us/frame %10.1f allocs/frame\n", ph.name, ph.time.count() / count / 1000.0,
+          ph.allocations / count);
+    } else {
+      std::printf("%-6s %10.2f us/frame %10s\n", ph.name, ph.time.count() / count / 1000.0, "-");
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  // Draw to an X window using each of the render backends
+  bool x11{argc > 1 && std::strcmp(argv[1], "--x11") == 0};
+
+  if (x11) {
+    argc--;
+    argv++;
+  }
+
+  if (argc < 4) {
+    std::fprintf(stderr, "Usage: %s [--x11] CONFIG BAR RECORDING [ITERATIONS]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  size_t iterations{argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 10UL};
+  auto frames = load_frames(argv[3]);
+
+  if (frames.empty()) {
+    std::fprintf(stderr, "No frames found in %s\n", argv[3]);
+    return EXIT_FAILURE;
+  }
+
+  logger::make(loglevel::WARNING);
+  config::make(argv[1], argv[2]);
+
+  // The bar is only used to load the settings
+  auto bar = bar::make(false, true);
+  const bar_settings settings{bar->settings()};
+
+  if (!x11) {
+    auto r = renderer::make(settings, config::make(), true);
+    replay(*r, settings, frames, iterations, false);
+    return EXIT_SUCCESS;
+  }
+
+  for (auto&& backend : {"xcb", "shm"}) {
+    config conf{logger::make(), argv[1], argv[2]};
+    conf.set("settings", "render-backend", backend);
+
+    std::printf("render-backend = %s\n", backend);
+    auto r = renderer::make(settings, conf, false);
+    replay(*r, settings, frames, iterations, true);
+  }
+
+  return EXIT_SUCCESS;
+}
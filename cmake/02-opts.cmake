@@ -8,6 +8,7 @@ checklib(ENABLE_I3 "binary" i3)
 checklib(ENABLE_MPD "pkg-config" libmpdclient)
 checklib(ENABLE_NETWORK "cmake" Libiw)
 checklib(WITH_XRM "pkg-config" xcb-xrm)
+checklib(WITH_XSHM "pkg-config" xcb-shm)
 checklib(WITH_XRANDR_MONITORS "pkg-config" "xcb-randr>=1.12")
 
 if(NOT DEFINED ENABLE_CCACHE AND CMAKE_BUILD_TYPE_UPPER MATCHES DEBUG)
@@ -36,6 +37,7 @@ option(WITH_XSYNC "xcb-sync support" OFF)
 option(WITH_XCOMPOSITE "xcb-composite support" OFF)
 option(WITH_XKB "xcb-xkb support" ON)
 option(WITH_XRM "xcb-xrm support" ON)
+option(WITH_XSHM "xcb-shm support" ON)
 
 if(CMAKE_BUILD_TYPE_UPPER MATCHES DEBUG)
   option(DEBUG_LOGGER "Debug logging" ON)
@@ -19,4 +19,5 @@ querylib(WITH_XRANDR "pkg-config" xcb-randr libs dirs)
 querylib(WITH_XRANDR_MONITORS "pkg-config" "xcb-randr>=1.12" libs dirs)
 querylib(WITH_XRENDER "pkg-config" xcb-render libs dirs)
 querylib(WITH_XRM "pkg-config" xcb-xrm libs dirs)
+querylib(WITH_XSHM "pkg-config" xcb-shm libs dirs)
 querylib(WITH_XSYNC "pkg-config" xcb-sync libs dirs)
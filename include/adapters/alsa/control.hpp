@@ -1,5 +1,6 @@
 #pragma once
 
+#include <poll.h>
 #include <mutex>
 
 #include "common.hpp"
@@ -26,6 +27,7 @@ namespace alsa {
 
     int get_numid();
     bool wait(int timeout = -1);
+    vector<struct pollfd> get_poll_descriptors();
     bool test_device_plugged();
     void process_events();
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <poll.h>
 #include <mutex>
 
 #include "common.hpp"
@@ -28,6 +29,7 @@ namespace alsa {
     const string& get_sound_card();
 
     bool wait(int timeout = -1);
+    vector<struct pollfd> get_poll_descriptors();
     int process_events();
 
     int get_volume();
@@ -33,6 +33,9 @@ namespace cairo {
     }
 
     virtual ~context() {
+      for (auto&& f : m_fonts) {
+        m_log.info("Glyph cache stats for \"%s\" (hits=%lu, misses=%lu)", f->name(), f->cache_hits(), f->cache_misses());
+      }
       cairo_destroy(m_c);
     }
 
@@ -145,29 +148,36 @@ namespace cairo {
       double x, y;
       position(&x, &y);
 
-      // Prioritize the preferred font
-      vector<shared_ptr<font>> fns(m_fonts.begin(), m_fonts.end());
+      // Prioritize the preferred font by swapping it with the first one
+      const size_t nfonts{m_fonts.size()};
+      size_t preferred{0};
 
-      if (t.font > 0 && t.font <= std::distance(fns.begin(), fns.end())) {
-        std::iter_swap(fns.begin(), fns.begin() + t.font - 1);
+      if (t.font > 0 && static_cast<size_t>(t.font) <= nfonts) {
+        preferred = t.font - 1;
       }
 
+      const auto font_at = [&](size_t n) -> const shared_ptr<font>& {
+        return m_fonts[n == 0 ? preferred : n == preferred ? 0 : n];
+      };
+
       string utf8 = string(t.contents);
       utils::unicode_charlist chars;
       utils::utf8_to_ucs4((const unsigned char*)utf8.c_str(), chars);
 
       while (!chars.empty()) {
         auto remaining = chars.size();
-        for (auto&& f : fns) {
+        for (size_t n = 0; n < nfonts; n++) {
+          const auto& f = font_at(n);
           unsigned int matches;
 
           // Match as many glyphs as possible if the default/preferred font
           // is being tested. Otherwise test one glyph at a time against
           // the remaining fonts. Roll back to the top of the font list
-          // when a glyph has been found.
-          if (f == fns.front() && (matches = f->match(chars)) == 0) {
+          // when a glyph has been found. Coverage is cached by the fonts
+          // so this doesn't touch the font faces for known codepoints.
+          if (n == 0 && (matches = f->match(chars)) == 0) {
             continue;
-          } else if (f != fns.front() && (matches = f->match(chars.front())) == 0) {
+          } else if (n != 0 && (matches = f->match(chars.front())) == 0) {
             continue;
           }
 
@@ -347,6 +357,17 @@ namespace cairo {
       return *this;
     }
 
+    /**
+     * Get the total time the loaded fonts spent converting text to glyphs
+     */
+    std::chrono::nanoseconds shaping_time() const {
+      std::chrono::nanoseconds total{0};
+      for (auto&& f : m_fonts) {
+        total += f->shaping_time();
+      }
+      return total;
+    }
+
    protected:
     cairo_t* m_c;
     const logger& m_log;
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <cairo/cairo-ft.h>
+#include <bitset>
+#include <chrono>
+#include <unordered_map>
 
 #include "cairo/types.hpp"
 #include "cairo/utils.hpp"
 #include "common.hpp"
 #include "errors.hpp"
 #include "settings.hpp"
+#include "utils/cache.hpp"
 #include "utils/math.hpp"
 #include "utils/scope.hpp"
 #include "utils/string.hpp"
@@ -38,16 +42,88 @@ namespace cairo {
       cairo_set_font_face(m_cairo, cairo_font_face_reference(m_font_face));
     }
 
-    virtual size_t match(utils::unicode_character& character) = 0;
-    virtual size_t match(utils::unicode_charlist& charlist) = 0;
+    /**
+     * Check if the font has a glyph for given character
+     */
+    size_t match(utils::unicode_character& character) {
+      return covers(character.codepoint) ? 1 : 0;
+    }
+
+    /**
+     * Get the number of leading characters the font has glyphs for
+     */
+    size_t match(utils::unicode_charlist& charlist) {
+      size_t available_chars = 0;
+      for (auto&& c : charlist) {
+        if (covers(c.codepoint)) {
+          available_chars++;
+        } else {
+          break;
+        }
+      }
+      return available_chars;
+    }
+
     virtual size_t render(const string& text, double x = 0.0, double y = 0.0) = 0;
     virtual void textwidth(const string& text, cairo_text_extents_t* extents) = 0;
 
+    virtual size_t cache_hits() const {
+      return 0;
+    }
+    virtual size_t cache_misses() const {
+      return 0;
+    }
+    virtual std::chrono::nanoseconds shaping_time() const {
+      return std::chrono::nanoseconds{0};
+    }
+
    protected:
+    virtual bool has_glyph(unsigned long codepoint) = 0;
+
+    /**
+     * Lookup codepoint in the coverage index, which is populated
+     * lazily so that the font face only gets queried once per codepoint
+     */
+    bool covers(unsigned long codepoint) {
+      auto& page = m_coverage[codepoint >> 8];
+      const size_t bit{codepoint & 0xFF};
+      if (!page.known.test(bit)) {
+        page.known.set(bit);
+        page.covered.set(bit, has_glyph(codepoint));
+      }
+      return page.covered.test(bit);
+    }
+
+    /**
+     * @brief Coverage of a block of 256 consecutive codepoints
+     */
+    struct coverage_page {
+      std::bitset<256> known;
+      std::bitset<256> covered;
+    };
+
     cairo_t* m_cairo;
     cairo_font_face_t* m_font_face{nullptr};
     cairo_font_extents_t m_extents{};
     double m_offset{0.0};
+    std::unordered_map<unsigned long, coverage_page> m_coverage;
+  };
+
+  /**
+   * @brief Result of converting a text run to glyphs,
+   * positioned relative to the origin
+   */
+  struct glyph_run {
+    vector<cairo_glyph_t> glyphs;
+    vector<cairo_text_cluster_t> clusters;
+    cairo_text_cluster_flags_t flags{};
+
+    // Number of leading bytes covered by the font
+    size_t bytes{0};
+    // Extents of the covered glyphs
+    cairo_text_extents_t extents{};
+    // Extents of the whole text run
+    cairo_text_extents_t text_extents{};
   };
 
   /**
@@ -55,7 +131,11 @@ namespace cairo {
    */
   class font_fc : public font {
    public:
-    explicit font_fc(cairo_t* cairo, FcPattern* pattern, double offset, double dpi_x, double dpi_y) : font(cairo, offset), m_pattern(pattern) {
+    explicit font_fc(cairo_t* cairo, FcPattern* pattern, double offset, double dpi_x, double dpi_y,
+        size_t cache_size = 256)
+        : font(cairo, offset)
+        , m_pattern(pattern)
+        , m_glyphcache(cache_size) {
       cairo_matrix_t fm;
       cairo_matrix_t ctm;
       cairo_matrix_init_scale(&fm, size(dpi_x), size(dpi_y));
@@ -131,87 +211,113 @@ namespace cairo {
       cairo_set_scaled_font(m_cairo, m_scaled);
     }
 
-    size_t match(utils::unicode_character& character) override {
-      auto lock = make_unique<utils::ft_face_lock>(m_scaled);
-      auto face = static_cast<FT_Face>(*lock);
-      return FT_Get_Char_Index(face, character.codepoint) ? 1 : 0;
+    size_t render(const string& text, double x = 0.0, double y = 0.0) override {
+      const glyph_run& run{convert(text)};
+
+      if (run.bytes) {
+        // auto lock = make_unique<utils::device_lock>(cairo_surface_get_device(cairo_get_target(m_cairo)));
+        // if (lock.get()) {
+        //   cairo_glyph_path(m_cairo, glyphs, nglyphs);
+        // }
+
+        m_glyphs.assign(run.glyphs.begin(), run.glyphs.end());
+        for (auto&& glyph : m_glyphs) {
+          glyph.x += x;
+          glyph.y += y;
+        }
+
+        cairo_show_text_glyphs(m_cairo, text.c_str(), run.bytes, m_glyphs.data(), m_glyphs.size(),
+            run.clusters.data(), run.clusters.size(), run.flags);
+        cairo_fill(m_cairo);
+        cairo_move_to(m_cairo, x + run.extents.x_advance, 0.0);
+      }
+
+      return run.bytes;
+    }
+
+    void textwidth(const string& text, cairo_text_extents_t* extents) override {
+      *extents = convert(text).text_extents;
+    }
+
+    size_t cache_hits() const override {
+      return m_glyphcache.hits();
+    }
+
+    size_t cache_misses() const override {
+      return m_glyphcache.misses();
+    }
+
+    std::chrono::nanoseconds shaping_time() const override {
+      return m_shaping;
     }
 
-    size_t match(utils::unicode_charlist& charlist) override {
+   protected:
+    bool has_glyph(unsigned long codepoint) override {
       auto lock = make_unique<utils::ft_face_lock>(m_scaled);
       auto face = static_cast<FT_Face>(*lock);
-      size_t available_chars = 0;
-      for (auto&& c : charlist) {
-        if (FT_Get_Char_Index(face, c.codepoint)) {
-          available_chars++;
+      return FT_Get_Char_Index(face, codepoint) != 0;
+    }
+
+    /**
+     * Get the glyphs for given text, converting it
+     * only if it's not found in the cache
+     */
+    const glyph_run& convert(const string& text) {
+      const glyph_run* cached{m_glyphcache.find(text)};
+      if (cached != nullptr) {
+        return *cached;
+      }
+
+      auto start = std::chrono::steady_clock::now();
+
+      glyph_run run{};
+      to_glyphs(text, run);
+      cairo_scaled_font_glyph_extents(m_scaled, run.glyphs.data(), run.glyphs.size(), &run.text_extents);
+
+      for (size_t g = 0; g < run.glyphs.size(); g++) {
+        if (run.glyphs[g].index) {
+          run.bytes += run.clusters[g].num_bytes;
         } else {
           break;
         }
       }
 
-      return available_chars;
+      // Only keep the glyphs of the prefix covered by the font
+      if (run.bytes && run.bytes < text.size()) {
+        to_glyphs(text.substr(0, run.bytes), run);
+      }
+
+      if (run.bytes) {
+        cairo_scaled_font_glyph_extents(m_scaled, run.glyphs.data(), run.glyphs.size(), &run.extents);
+      }
+
+      m_shaping += std::chrono::steady_clock::now() - start;
+
+      return m_glyphcache.insert(text, move(run));
     }
 
-    size_t render(const string& text, double x = 0.0, double y = 0.0) override {
+    /**
+     * Wrapper for cairo_scaled_font_text_to_glyphs
+     */
+    void to_glyphs(const string& utf8, glyph_run& run) {
       cairo_glyph_t* glyphs{nullptr};
       cairo_text_cluster_t* clusters{nullptr};
-      cairo_text_cluster_flags_t cf{};
       int nglyphs = 0, nclusters = 0;
 
-      string utf8 = string(text);
       auto status = cairo_scaled_font_text_to_glyphs(
-          m_scaled, x, y, utf8.c_str(), utf8.size(), &glyphs, &nglyphs, &clusters, &nclusters, &cf);
+          m_scaled, 0.0, 0.0, utf8.c_str(), utf8.size(), &glyphs, &nglyphs, &clusters, &nclusters, &run.flags);
 
       if (status != CAIRO_STATUS_SUCCESS) {
         throw application_error(sstream() << "cairo_scaled_font_text_to_glyphs()" << cairo_status_to_string(status));
       }
 
-      size_t bytes = 0;
-      for (int g = 0; g < nglyphs; g++) {
-        if (glyphs[g].index) {
-          bytes += clusters[g].num_bytes;
-        } else {
-          break;
-        }
-      }
-
-      if (bytes && bytes < text.size()) {
-        cairo_glyph_free(glyphs);
-        cairo_text_cluster_free(clusters);
-
-        utf8 = text.substr(0, bytes);
-        auto status = cairo_scaled_font_text_to_glyphs(
-            m_scaled, x, y, utf8.c_str(), utf8.size(), &glyphs, &nglyphs, &clusters, &nclusters, &cf);
-
-        if (status != CAIRO_STATUS_SUCCESS) {
-          throw application_error(sstream() << "cairo_scaled_font_text_to_glyphs()" << cairo_status_to_string(status));
-        }
-      }
-
-      if (bytes) {
-        // auto lock = make_unique<utils::device_lock>(cairo_surface_get_device(cairo_get_target(m_cairo)));
-        // if (lock.get()) {
-        //   cairo_glyph_path(m_cairo, glyphs, nglyphs);
-        // }
-
-        cairo_text_extents_t extents{};
-        cairo_scaled_font_glyph_extents(m_scaled, glyphs, nglyphs, &extents);
-        cairo_show_text_glyphs(m_cairo, utf8.c_str(), utf8.size(), glyphs, nglyphs, clusters, nclusters, cf);
-        cairo_fill(m_cairo);
-        cairo_move_to(m_cairo, x + extents.x_advance, 0.0);
-      }
+      run.glyphs.assign(glyphs, glyphs + nglyphs);
+      run.clusters.assign(clusters, clusters + nclusters);
 
       cairo_glyph_free(glyphs);
       cairo_text_cluster_free(clusters);
-
-      return bytes;
     }
 
-    void textwidth(const string& text, cairo_text_extents_t* extents) override {
-      cairo_scaled_font_text_extents(m_scaled, text.c_str(), extents);
-    }
-
-   protected:
     string property(string&& property) const {
       FcChar8* file;
       if (FcPatternGetString(m_pattern, property.c_str(), 0, &file) == FcResultMatch) {
@@ -238,12 +344,19 @@ namespace cairo {
    private:
     cairo_scaled_font_t* m_scaled{nullptr};
     FcPattern* m_pattern{nullptr};
+
+    lru_cache<string, glyph_run> m_glyphcache;
+    vector<cairo_glyph_t> m_glyphs;
+
+    // Time spent converting text that wasn't found in the cache
+    std::chrono::nanoseconds m_shaping{0};
   };
 
   /**
    * Match and create font from given fontconfig pattern
    */
-  decltype(auto) make_font(cairo_t* cairo, string&& fontname, double offset, double dpi_x, double dpi_y) {
+  decltype(auto) make_font(
+      cairo_t* cairo, string&& fontname, double offset, double dpi_x, double dpi_y, size_t cache_size = 256) {
     static bool fc_init{false};
     if (!fc_init && !(fc_init = FcInit())) {
       throw application_error("Could not load fontconfig");
@@ -272,7 +385,7 @@ namespace cairo {
     FcPatternPrint(match);
 #endif
 
-    return make_shared<font_fc>(cairo, match, offset, dpi_x, dpi_y);
+    return make_shared<font_fc>(cairo, match, offset, dpi_x, dpi_y, cache_size);
   }
 }
 
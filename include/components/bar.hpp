@@ -9,6 +9,7 @@
 #include "events/signal_fwd.hpp"
 #include "events/signal_receiver.hpp"
 #include "settings.hpp"
+#include "utils/concurrency.hpp"
 #include "x11/types.hpp"
 #include "x11/window.hpp"
 
@@ -18,7 +19,6 @@ POLYBAR_NS
 class config;
 class connection;
 class logger;
-class parser;
 class renderer;
 class screen;
 class taskqueue;
@@ -28,20 +28,25 @@ class tray_manager;
 class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::property_notify, evt::enter_notify,
                 evt::leave_notify, evt::destroy_notify, evt::client_message>,
             public signal_receiver<SIGN_PRIORITY_BAR, signals::eventqueue::start, signals::ui::tick,
-                signals::ui::shade_window, signals::ui::unshade_window, signals::ui::dim_window> {
+                signals::ui::shade_window, signals::ui::unshade_window, signals::ui::dim_window,
+                signals::ui::request_snapshot> {
  public:
   using make_type = unique_ptr<bar>;
-  static make_type make(bool only_initialize_values = false);
+  static make_type make(bool only_initialize_values = false, bool headless = false);
+  static make_type make(const config& conf, bool headless = false);
 
-  explicit bar(connection&, signal_emitter&, const config&, const logger&, unique_ptr<screen>&&,
-      unique_ptr<tray_manager>&&, unique_ptr<parser>&&, unique_ptr<taskqueue>&&, bool only_initialize_values);
+  explicit bar(connection*, signal_emitter&, const config&, const logger&, unique_ptr<screen>&&,
+      unique_ptr<tray_manager>&&, unique_ptr<taskqueue>&&, bool only_initialize_values);
   ~bar();
 
   const bar_settings settings() const;
 
-  void parse(string&& data, bool force = false);
+  void draw(const display_list& commands, bool force = false);
 
  protected:
+  void render_frames();
+  void render(const display_list& commands, bool force);
+  void load_monitor(const string& bs);
   void restack_window();
   void reconfigure_pos();
   void reconfigure_struts();
@@ -61,21 +66,21 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   bool on(const signals::ui::shade_window&);
   bool on(const signals::ui::tick&);
   bool on(const signals::ui::dim_window&);
+  bool on(const signals::ui::request_snapshot&);
 
  private:
-  connection& m_connection;
+  // Not set when rendering offscreen without an X server
+  connection* m_connection;
   signal_emitter& m_sig;
   const config& m_conf;
   const logger& m_log;
   unique_ptr<screen> m_screen;
   unique_ptr<tray_manager> m_tray{};
   unique_ptr<renderer> m_renderer{};
-  unique_ptr<parser> m_parser{};
   unique_ptr<taskqueue> m_taskqueue;
 
   bar_settings m_opts{};
 
-  string m_lastinput{};
   std::mutex m_mutex{};
   std::atomic<bool> m_dblclicks{false};
 
@@ -86,6 +91,30 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   event_timer m_doubleclick{0L, 150L};
 
   double m_anim_step{0.0};
+
+  /**
+   * @brief Composed contents waiting to be drawn
+   */
+  struct frame {
+    display_list commands;
+    bool force{false};
+    string snapshot_dst{};
+  };
+
+  /**
+   * @brief Snapshot destination handed to the renderer with the next frame
+   */
+  string m_snapshot_dst;
+
+  /**
+   * @brief Latest frame handed over by the controller
+   */
+  mailbox<frame> m_frames;
+
+  /**
+   * @brief Thread drawing the posted frames
+   */
+  thread m_render_thread;
 };
 
 POLYBAR_NS_END
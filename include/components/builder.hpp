@@ -18,12 +18,24 @@ namespace drawtypes {
 }
 using namespace drawtypes;
 
+class parser;
+
+/**
+ * Builds the draw commands of module output
+ *
+ * Raw markup found in labels and format strings is converted
+ * into draw commands as it gets inserted
+ */
 class builder {
  public:
   explicit builder(const bar_settings& bar);
+  ~builder();
+
+  static string markup(const bar_settings& bar, const display_list& commands);
 
-  string flush();
+  display_list flush();
   void append(string text);
+  void append(display_list commands);
   void node(string str, bool add_space = false);
   void node(string str, int font_index, bool add_space = false);
   void node(const label_t& label, bool add_space = false);
@@ -59,17 +71,23 @@ class builder {
   string background_hex();
   string foreground_hex();
 
-  void tag_open(syntaxtag tag, const string& value);
+  void push(drawcmd cmd);
+  void action(const string& tag);
+  void tags(const string& block);
+
+  void tag_open(syntaxtag tag, drawcmd cmd);
   void tag_open(attribute attr);
   void tag_close(syntaxtag tag);
   void tag_close(attribute attr);
 
  private:
   const bar_settings m_bar;
-  string m_output;
+  display_list m_output;
+  unique_ptr<parser> m_parser;
 
   map<syntaxtag, int> m_tags{};
   map<syntaxtag, string> m_colors{};
+  vector<int> m_actions{};
 
   int m_attributes{0};
   int m_fontindex{0};
@@ -50,6 +50,7 @@ class config {
       valuemap_t values;
       values[key] = value;
       m_sections[section] = move(values);
+      return;
     }
     auto it2 = it->second.find(key);
     if ((it2 = it->second.find(key)) == it->second.end()) {
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <moodycamel/blockingconcurrentqueue.h>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include <thread>
+#include <unordered_set>
 
 #include "common.hpp"
+#include "components/types.hpp"
 #include "settings.hpp"
 #include "events/signal_fwd.hpp"
 #include "events/signal_receiver.hpp"
@@ -17,19 +22,20 @@ POLYBAR_NS
 
 enum class alignment;
 class bar;
-class command;
 class config;
 class connection;
+class eventloop;
 class inotify_watch;
 class ipc;
 class logger;
 class signal_emitter;
+class spawner;
 namespace modules {
   struct module_interface;
   class input_handler;
 }
 using module_t = unique_ptr<modules::module_interface>;
-using modulemap_t = std::map<alignment, vector<module_t>>;
+using modulemap_t = std::map<alignment, vector<modules::module_interface*>>;
 
 // }}}
 
@@ -38,22 +44,68 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
                        signals::ipc::command, signals::ipc::hook, signals::ui::ready, signals::ui::button_press> {
  public:
   using make_type = unique_ptr<controller>;
-  static make_type make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch);
+  static make_type make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch, bool headless = false,
+      const vector<string>& extra_bars = {});
 
-  explicit controller(connection&, signal_emitter&, const logger&, const config&, unique_ptr<bar>&&, unique_ptr<ipc>&&,
-      unique_ptr<inotify_watch>&&);
+  explicit controller(connection*, signal_emitter&, const logger&, const config&, eventloop&,
+      vector<unique_ptr<config>>&&, vector<unique_ptr<bar>>&&, unique_ptr<ipc>&&, unique_ptr<inotify_watch>&&);
   ~controller();
 
-  bool run(bool writeback, string snapshot_dst);
+  bool run(bool writeback, string snapshot_dst, string record_dst = "");
 
   bool enqueue(event&& evt);
   bool enqueue(string&& input_data);
 
  protected:
+  /**
+   * @brief Bar hosted by the controller together with the contents drawn on it
+   */
+  struct hosted_bar {
+    unique_ptr<bar> instance;
+
+    /**
+     * @brief Configuration of the bar section
+     */
+    const config* conf{nullptr};
+
+    /**
+     * @brief Modules shown on the bar, owned by the controller
+     */
+    modulemap_t modules;
+
+    /**
+     * @brief Cached output of each module, indexed like the entries in modules
+     */
+    std::map<alignment, vector<display_list>> segments;
+
+    /**
+     * @brief Cached contents of each alignment block
+     */
+    std::map<alignment, display_list> blocks;
+
+    /**
+     * @brief Markup of each alignment block, only kept when writing to stdout or recording frames
+     */
+    std::map<alignment, string> markup;
+
+    /**
+     * @brief Draw commands of the module separator
+     */
+    display_list separator;
+  };
+
   void read_events();
+  void watch_config();
+  void watch_ipc();
   void process_eventqueue();
   void process_inputdata();
+  void process_commands();
+  void schedule_frame(bool force);
+  void draw_frame();
   bool process_update(bool force);
+  bool update_bar(
+      hosted_bar& hosted, const std::map<modules::module_interface*, display_list>& contents, bool force);
+  display_list compose_block(const hosted_bar& hosted, alignment align) const;
 
   bool on(const signals::eventqueue::notify_change& evt);
   bool on(const signals::eventqueue::notify_forcechange& evt);
@@ -67,16 +119,25 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
   bool on(const signals::ipc::hook& evt);
 
  private:
-  connection& m_connection;
+  // Not set when rendering offscreen without an X server
+  connection* m_connection;
   signal_emitter& m_sig;
   const logger& m_log;
   const config& m_conf;
-  unique_ptr<bar> m_bar;
+  eventloop& m_loop;
+
+  /**
+   * @brief Configuration of the bars following the first one
+   */
+  vector<unique_ptr<config>> m_confs;
+
+  /**
+   * @brief Hosted bars, the first one is configured by the main config instance
+   */
+  vector<hosted_bar> m_bars;
+
   unique_ptr<ipc> m_ipc;
   unique_ptr<inotify_watch> m_confwatch;
-  unique_ptr<command> m_command;
-
-  array<unique_ptr<file_descriptor>, 2> m_queuefd{};
 
   /**
    * @brief State flag
@@ -88,6 +149,33 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
    */
   string m_snapshot_dst;
 
+  /**
+   * @brief Modules that haven't produced any output before the snapshot
+   */
+  std::unordered_set<string> m_snapshot_pending;
+
+  /**
+   * @brief Set when the snapshot should be taken regardless of pending modules
+   */
+  std::atomic<bool> m_snapshot_timeout{false};
+
+  /**
+   * @brief Timer used to give up waiting for pending modules
+   *
+   * Only closed by the main thread once the event loop has stopped
+   */
+  int m_snapshot_timer{-1};
+
+  /**
+   * @brief Guards the snapshot destination and timer
+   */
+  std::mutex m_snapshotlock;
+
+  /**
+   * @brief Stream receiving the contents of each drawn frame
+   */
+  unique_ptr<std::ofstream> m_record;
+
   /**
    * @brief Controls weather the output gets printed to stdout
    */
@@ -99,9 +187,19 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
   moodycamel::BlockingConcurrentQueue<event> m_queue;
 
   /**
-   * @brief Loaded modules
+   * @brief Loaded modules, shared by every bar listing them
    */
-  modulemap_t m_modules;
+  vector<module_t> m_modules;
+
+  /**
+   * @brief Names of the modules that broadcasted since the last update
+   */
+  std::unordered_set<string> m_dirty;
+
+  /**
+   * @brief Lock protecting the dirty module set
+   */
+  std::mutex m_dirtylock;
 
   /**
    * @brief Module input handlers
@@ -109,14 +207,39 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
   vector<modules::input_handler*> m_inputhandlers;
 
   /**
-   * @brief Maximum number of subsequent events to swallow
+   * @brief Minimum time between two frames
+   */
+  std::chrono::milliseconds m_frame_interval{33};
+
+  /**
+   * @brief Maximum time a burst of changes may postpone its frame, 0 to disable
+   */
+  std::chrono::milliseconds m_frame_deadline{0};
+
+  /**
+   * @brief Earliest time the next frame may be drawn
+   */
+  std::chrono::steady_clock::time_point m_next_frame{};
+
+  /**
+   * @brief Time of the first change merged into the pending frame
+   */
+  std::chrono::steady_clock::time_point m_frame_first{};
+
+  /**
+   * @brief Time at which the pending frame gets drawn
+   */
+  std::chrono::steady_clock::time_point m_frame_due{};
+
+  /**
+   * @brief Set when changes are waiting for the next frame
    */
-  size_t m_swallow_limit{5U};
+  bool m_frame_pending{false};
 
   /**
-   * @brief Time to wait for subsequent events
+   * @brief Set when the next frame has to redraw every module
    */
-  std::chrono::milliseconds m_swallow_update{10};
+  bool m_frame_force{false};
 
   /**
    * @brief Time to throttle input events
@@ -133,6 +256,29 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
    */
   string m_inputdata;
 
+  /**
+   * @brief Run the shell commands spawned for the same action one at a time
+   */
+  bool m_serialize_actions{true};
+
+  /**
+   * @brief Shell commands that finished since the last COMMAND event, with their exit status
+   */
+  vector<pair<string, int>> m_exited;
+
+  /**
+   * @brief Lock protecting the finished command list
+   */
+  std::mutex m_exitedlock;
+
+  /**
+   * @brief Runs the actions that no module handled
+   *
+   * Declared after the members used by its callback, so that
+   * it is destroyed first
+   */
+  unique_ptr<spawner> m_spawner;
+
   /**
    * @brief Thread for the eventqueue loop
    */
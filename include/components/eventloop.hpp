@@ -0,0 +1,76 @@
+#pragma once
+
+#include <sys/epoll.h>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+#include "common.hpp"
+#include "errors.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+// fwd
+class logger;
+
+DEFINE_ERROR(eventloop_error);
+
+/**
+ * Edge-triggered epoll reactor driving the main thread.
+ *
+ * Components and modules register the file descriptors they
+ * want to be notified about together with a callback that
+ * gets invoked from the thread running `dispatch()`. Since the
+ * descriptors are registered with EPOLLET the callbacks are
+ * expected to drain the descriptor until it would block.
+ *
+ * Example usage:
+ *
+ * @code cpp
+ *   auto& loop = eventloop::make();
+ *   loop.add(fd, EPOLLIN, [](int fd, unsigned int) { drain(fd); });
+ *   auto timer = loop.add_timer(1s, [] { tick(); });
+ *   while (loop.dispatch()) {}
+ *   loop.remove_timer(timer);
+ * @endcode
+ */
+class eventloop : non_copyable_mixin<eventloop> {
+ public:
+  using make_type = eventloop&;
+  static make_type make();
+
+  using fd_callback = function<void(int fd, unsigned int events)>;
+  using timer_callback = function<void()>;
+  using duration = chrono::milliseconds;
+
+  explicit eventloop(const logger& logger);
+  ~eventloop();
+
+  void add(int fd, unsigned int events, fd_callback cb, bool edge_triggered = true);
+  void modify(int fd, unsigned int events, bool edge_triggered = true);
+  void remove(int fd);
+
+  int add_timer(duration interval, timer_callback cb, bool repeat = true);
+  void remove_timer(int timer);
+
+  bool dispatch(int timeout_ms = -1);
+  void wakeup() const;
+  int get_wakeup_fd() const;
+
+ protected:
+  void ctl(int op, int fd, unsigned int events, bool edge_triggered);
+
+ private:
+  const logger& m_log;
+
+  int m_epollfd{-1};
+  int m_eventfd{-1};
+
+  std::mutex m_lock;
+  std::unordered_map<int, shared_ptr<fd_callback>> m_handlers;
+};
+
+POLYBAR_NS_END
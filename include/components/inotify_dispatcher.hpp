@@ -0,0 +1,73 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+
+#include "common.hpp"
+#include "utils/inotify.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+// fwd
+class eventloop;
+class logger;
+
+/**
+ * Routes the events of a single process-wide inotify instance
+ *
+ * The inotify descriptor is registered with the event loop and each
+ * subscription keeps its watch descriptor until it is removed. Events
+ * are delivered to the subscribers of the watch descriptor they were
+ * reported for. Subscribers watching the same path share the watch
+ * descriptor and are notified for the union of their masks.
+ *
+ * Example usage:
+ *
+ * @code cpp
+ *   auto& inotify = inotify_dispatcher::make();
+ *   auto id = inotify.add("/sys/class/power_supply/BAT0/status", IN_MODIFY, [](const inotify_event& e) { ... });
+ *   ...
+ *   inotify.remove(id);
+ * @endcode
+ */
+class inotify_dispatcher : non_copyable_mixin<inotify_dispatcher> {
+ public:
+  using callback = function<void(const inotify_event& event)>;
+  using subscription_id = size_t;
+
+  using make_type = inotify_dispatcher&;
+  static make_type make();
+
+  explicit inotify_dispatcher(const logger& logger, eventloop& loop);
+  ~inotify_dispatcher();
+
+  subscription_id add(const string& path, int mask, callback cb);
+  void remove(subscription_id id);
+
+ protected:
+  struct subscription {
+    string path;
+    int wd;
+    int mask;
+    callback cb;
+  };
+
+  void read_events();
+
+ private:
+  const logger& m_log;
+  eventloop& m_loop;
+
+  int m_fd{-1};
+
+  /**
+   * Callbacks are invoked with the lock held so that a removed
+   * subscription is guaranteed not to be notified anymore
+   */
+  std::mutex m_lock;
+  subscription_id m_nextid{1};
+  std::map<subscription_id, subscription> m_subscriptions;
+};
+
+POLYBAR_NS_END
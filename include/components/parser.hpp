@@ -5,10 +5,11 @@
 
 POLYBAR_NS
 
-class signal_emitter;
 enum class attribute;
 enum class mousebtn;
 struct bar_settings;
+struct drawcmd;
+using display_list = vector<drawcmd>;
 
 DEFINE_ERROR(parser_error);
 DEFINE_CHILD_ERROR(unrecognized_token, parser_error);
@@ -21,21 +22,19 @@ class parser {
   static make_type make();
 
  public:
-  explicit parser(signal_emitter& emitter);
-  void parse(const bar_settings& bar, string data);
+  void parse(const bar_settings& bar, const string& data, display_list& output);
 
  protected:
-  void codeblock(string&& data, const bar_settings& bar);
-  size_t text(string&& data);
+  void codeblock(const string& data, size_t pos, size_t end, const bar_settings& bar, display_list& output);
+  void text(const string& data, size_t pos, size_t len, display_list& output);
 
-  unsigned int parse_color(const string& s, unsigned int fallback = 0);
-  int parse_fontindex(const string& s);
+  unsigned int parse_color(const string& data, size_t pos, size_t len, unsigned int fallback = 0);
+  int parse_fontindex(const string& data, size_t pos, size_t len);
   attribute parse_attr(const char attr);
-  mousebtn parse_action_btn(const string& data);
-  string parse_action_cmd(string&& data);
+  mousebtn parse_action_btn(const char btn);
+  string parse_action_cmd(const string& data, size_t pos, size_t end);
 
  private:
-  signal_emitter& m_sig;
   vector<int> m_actions;
   unique_ptr<parser> m_parser;
 };
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <sys/types.h>
+#include <map>
+#include <mutex>
+
+#include "common.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+// fwd
+class eventloop;
+class logger;
+
+/**
+ * Collects exited child processes from the main event loop
+ *
+ * Each watched child is tracked through its pidfd, which is registered
+ * with the event loop. When pidfd_open(2) isn't available, SIGCHLD is
+ * received through a signalfd instead and every watched child is
+ * checked once it fires. The exit notification is delivered from the
+ * thread running the event loop.
+ *
+ * The owner of a child can stop watching it with `release()` and
+ * collect it itself, which doesn't depend on the event loop running.
+ *
+ * @note Without pidfd support SIGCHLD gets blocked in the thread creating
+ * the instance, so it has to be created before any other thread is started
+ */
+class reaper : non_copyable_mixin<reaper> {
+ public:
+  using callback = function<void(int status)>;
+
+  using make_type = reaper&;
+  static make_type make();
+
+  explicit reaper(const logger& logger, eventloop& loop);
+  ~reaper();
+
+  void watch(pid_t pid, int pidfd, callback on_exit);
+  bool release(pid_t pid);
+  void wait_all();
+
+ protected:
+  struct child {
+    int pidfd;
+    callback on_exit;
+  };
+
+  bool collect(pid_t pid, int waitflags);
+  void collect_all();
+
+ private:
+  const logger& m_log;
+  eventloop& m_loop;
+
+  int m_signalfd{-1};
+
+  std::mutex m_lock;
+  std::map<pid_t, child> m_children;
+};
+
+POLYBAR_NS_END
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <bitset>
+#include <chrono>
+#include <map>
 #include <cairo/cairo.h>
 
 #include "cairo/fwd.hpp"
@@ -17,6 +19,7 @@ POLYBAR_NS
 class connection;
 class config;
 class logger;
+class shm_segment;
 // }}}
 
 using std::map;
@@ -25,26 +28,45 @@ struct alignment_block {
   cairo_pattern_t* pattern;
   double x;
   double y;
+
+  // Commands drawn into the block during the current and
+  // the previous frame, used to detect unchanged blocks
+  display_list contents{};
+  display_list prev_contents{};
+
+  // Position and width of the block in the previous frame
+  int prev_x{0};
+  int prev_w{0};
+
+  // Set when the pattern of the previous frame is reused
+  bool reused{false};
+  size_t first_action{0};
+
+  // Pattern and end state of the block when it was last drawn,
+  // reused as long as the block contents don't change
+  cairo_pattern_t* cache{nullptr};
+  bool cacheable{false};
+  double cache_x{0.0};
+  double cache_y{0.0};
+  vector<action_block> cache_actions{};
+  display_list cache_state{};
 };
 
-class renderer
-    : public signal_receiver<SIGN_PRIORITY_RENDERER, signals::ui::request_snapshot, signals::parser::change_background,
-          signals::parser::change_foreground, signals::parser::change_underline, signals::parser::change_overline,
-          signals::parser::change_font, signals::parser::change_alignment, signals::parser::offset_pixel,
-          signals::parser::attribute_set, signals::parser::attribute_unset, signals::parser::attribute_toggle,
-          signals::parser::action_begin, signals::parser::action_end, signals::parser::text> {
+class renderer : public signal_receiver<SIGN_PRIORITY_RENDERER, signals::ui::request_snapshot> {
  public:
   using make_type = unique_ptr<renderer>;
-  static make_type make(const bar_settings& bar);
+  static make_type make(const bar_settings& bar, const config& conf, bool headless = false);
 
   explicit renderer(
-      connection& conn, signal_emitter& sig, const config&, const logger& logger, const bar_settings& bar);
+      connection* conn, signal_emitter& sig, const config&, const logger& logger, const bar_settings& bar);
   ~renderer();
 
   xcb_window_t window() const;
   const vector<action_block> actions() const;
+  std::chrono::nanoseconds shaping_time() const;
 
   void begin(xcb_rectangle_t rect);
+  void render(const display_list& commands);
   void end();
   void flush();
 
@@ -58,28 +80,37 @@ class renderer
   void draw_text(const string& contents);
 
  protected:
+  void setup_window();
+
   double block_x(alignment a) const;
   double block_y(alignment a) const;
   double block_w(alignment a) const;
   double block_h(alignment a) const;
 
+  void record_state(display_list& contents) const;
+  bool reuse_block(alignment align, display_list::const_iterator first, display_list::const_iterator last);
+  void finish_block();
+
   void flush(alignment a);
+  void flush(const vector<xcb_rectangle_t>& areas);
   void highlight_clickable_areas();
 
+  vector<xcb_rectangle_t> compute_damage();
+
+  void change_background(unsigned int color);
+  void change_foreground(unsigned int color);
+  void change_underline(unsigned int color);
+  void change_overline(unsigned int color);
+  void change_font(int font);
+  void change_alignment(alignment align);
+  void offset_pixel(int px);
+  void attribute_set(attribute attr);
+  void attribute_unset(attribute attr);
+  void attribute_toggle(attribute attr);
+  void action_begin(mousebtn btn, const string& command);
+  void action_end(mousebtn btn);
+
   bool on(const signals::ui::request_snapshot& evt);
-  bool on(const signals::parser::change_background& evt);
-  bool on(const signals::parser::change_foreground& evt);
-  bool on(const signals::parser::change_underline& evt);
-  bool on(const signals::parser::change_overline& evt);
-  bool on(const signals::parser::change_font& evt);
-  bool on(const signals::parser::change_alignment& evt);
-  bool on(const signals::parser::offset_pixel& evt);
-  bool on(const signals::parser::attribute_set& evt);
-  bool on(const signals::parser::attribute_unset& evt);
-  bool on(const signals::parser::attribute_toggle& evt);
-  bool on(const signals::parser::action_begin& evt);
-  bool on(const signals::parser::action_end& evt);
-  bool on(const signals::parser::text& evt);
 
  protected:
   struct reserve_area {
@@ -88,26 +119,35 @@ class renderer
   };
 
  private:
-  connection& m_connection;
+  // Not set when rendering offscreen without an X server
+  connection* m_connection;
   signal_emitter& m_sig;
   const config& m_conf;
   const logger& m_log;
   const bar_settings& m_bar;
 
   int m_depth{32};
-  xcb_window_t m_window;
-  xcb_colormap_t m_colormap;
-  xcb_visualtype_t* m_visual;
-  xcb_gcontext_t m_gcontext;
-  xcb_pixmap_t m_pixmap;
+  xcb_window_t m_window{XCB_NONE};
+  xcb_colormap_t m_colormap{XCB_NONE};
+  xcb_visualtype_t* m_visual{nullptr};
+  xcb_gcontext_t m_gcontext{XCB_NONE};
+  xcb_pixmap_t m_pixmap{XCB_NONE};
 
   xcb_rectangle_t m_rect{0, 0, 0U, 0U};
   reserve_area m_cleararea{};
 
+  // Repaint the whole pixmap with the next frame
+  bool m_fulldamage{true};
+
   // bool m_autosize{false};
 
+#if WITH_XSHM
+  // Set when frames are pushed through MIT-SHM instead of the pixmap
+  unique_ptr<shm_segment> m_shm;
+#endif
+
   unique_ptr<cairo::context> m_context;
-  unique_ptr<cairo::xcb_surface> m_surface;
+  unique_ptr<cairo::surface> m_surface;
   map<alignment, alignment_block> m_blocks;
   cairo_pattern_t* m_cornermask{};
 
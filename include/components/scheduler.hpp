@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "common.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+// fwd
+class logger;
+
+/**
+ * Runs timed tasks on a small pool of worker threads
+ *
+ * Timers are kept in a hierarchical timing wheel with a resolution
+ * of `TICK`. A single thread advances the wheel and sleeps until the
+ * next slot that holds a timer. It hands the expired timers to the
+ * workers. A timer never runs concurrently with itself. If it expires
+ * again while it's running, it runs once more right after.
+ *
+ * Example usage:
+ *
+ * @code cpp
+ *   auto& sched = scheduler::make();
+ *   auto id = sched.add([&] { update(); sched.arm(id, 1s); });
+ *   sched.arm(id, 0ms);
+ *   ...
+ *   sched.remove(id);
+ * @endcode
+ */
+class scheduler : non_copyable_mixin<scheduler> {
+ public:
+  using task = function<void()>;
+  using duration = chrono::milliseconds;
+  using timer_id = size_t;
+
+  using make_type = scheduler&;
+  static make_type make(size_t workers = 2);
+
+  static constexpr duration TICK{10};
+
+  explicit scheduler(const logger& logger, size_t workers);
+  ~scheduler();
+
+  timer_id add(task fn);
+  void arm(timer_id id, duration delay);
+  void remove(timer_id id);
+
+ protected:
+  static constexpr size_t LEVEL_BITS{6};
+  static constexpr size_t SLOTS{1 << LEVEL_BITS};
+  static constexpr size_t LEVELS{4};
+
+  struct timer {
+    task fn;
+    uint64_t generation{0};
+    bool armed{false};
+    bool running{false};
+    bool again{false};
+    std::thread::id runner{};
+  };
+
+  struct slot_entry {
+    timer_id id;
+    uint64_t generation;
+    uint64_t expires;
+  };
+
+  uint64_t now_tick() const;
+  void insert(const slot_entry& entry);
+  void advance();
+  void expire(const slot_entry& entry);
+  uint64_t next_tick() const;
+
+  void tick_loop();
+  void work();
+
+ private:
+  const logger& m_log;
+
+  std::mutex m_lock;
+  std::condition_variable m_tickcond;
+  std::condition_variable m_workcond;
+  std::condition_variable m_donecond;
+  bool m_active{true};
+
+  const chrono::steady_clock::time_point m_epoch{chrono::steady_clock::now()};
+  uint64_t m_tick{0};
+  std::array<std::array<vector<slot_entry>, SLOTS>, LEVELS> m_wheel;
+
+  timer_id m_nextid{1};
+  std::unordered_map<timer_id, shared_ptr<timer>> m_timers;
+
+  /**
+   * Expired timers waiting for a worker
+   */
+  std::deque<timer_id> m_ready;
+
+  std::thread m_ticker;
+  vector<std::thread> m_workers;
+};
+
+POLYBAR_NS_END
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "common.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+// fwd
+class logger;
+
+/**
+ * Runs shell commands on a bounded set of worker threads
+ *
+ * Commands sharing a non-empty serialization key never run
+ * concurrently and are started in the order they were spawned.
+ * The callback is invoked from the worker thread once the
+ * command has finished.
+ *
+ * Example usage:
+ *
+ * @code cpp
+ *   auto spawner = spawner::make(4);
+ *   spawner->spawn("notify-send foo", [](const string& cmd, int status) { ... }, "key");
+ * @endcode
+ */
+class spawner : non_copyable_mixin<spawner> {
+ public:
+  using callback = function<void(const string& cmd, int status)>;
+
+  using make_type = unique_ptr<spawner>;
+  static make_type make(size_t limit);
+
+  explicit spawner(const logger& logger, size_t limit);
+  ~spawner();
+
+  void spawn(string cmd, callback done, string key = "");
+
+ protected:
+  struct job {
+    string cmd;
+    string key;
+    callback done;
+  };
+
+  void work();
+
+ private:
+  const logger& m_log;
+
+  std::mutex m_lock;
+  std::condition_variable m_cond;
+  bool m_active{true};
+
+  /**
+   * @brief Commands waiting for a free worker
+   */
+  std::deque<job> m_jobs;
+
+  /**
+   * @brief Serialization keys of the commands currently running
+   */
+  std::unordered_set<string> m_busy;
+
+  /**
+   * @brief Process groups of the commands currently running
+   */
+  std::unordered_set<pid_t> m_running;
+
+  vector<std::thread> m_workers;
+};
+
+POLYBAR_NS_END
@@ -108,6 +108,47 @@ struct action_block : public action {
   }
 };
 
+enum class drawtype {
+  NONE = 0,
+  ALIGNMENT,
+  BACKGROUND,
+  FOREGROUND,
+  UNDERLINE,
+  OVERLINE,
+  FONT,
+  OFFSET,
+  ATTRIBUTE_SET,
+  ATTRIBUTE_UNSET,
+  ATTRIBUTE_TOGGLE,
+  ACTION_BEGIN,
+  ACTION_END,
+  TEXT,
+};
+
+/**
+ * Single entry of a display list
+ *
+ * Colors are stored pre-parsed as packed ARGB values. The
+ * remaining scalar arguments (font index, pixel offset,
+ * alignment, attribute and mouse button) are stored in value
+ * and the text run or action command in data.
+ */
+struct drawcmd {
+  drawtype type{drawtype::NONE};
+  unsigned int color{0U};
+  int value{0};
+  string data{};
+
+  bool operator==(const drawcmd& other) const {
+    return type == other.type && color == other.color && value == other.value && data == other.data;
+  }
+  bool operator!=(const drawcmd& other) const {
+    return !(*this == other);
+  }
+};
+
+using display_list = vector<drawcmd>;
+
 struct bar_settings {
   explicit bar_settings() = default;
   bar_settings(const bar_settings& other) = default;
@@ -40,7 +40,9 @@ namespace drawtypes {
     size_t m_maxlen{0_z};
     bool m_ellipsis{true};
 
-    explicit label(string text, int font) : m_font(font), m_text(text), m_tokenized(m_text) {}
+    explicit label(string text, int font) : m_font(font), m_text(text) {
+      compile(m_text);
+    }
     explicit label(string text, string foreground = ""s, string background = ""s, string underline = ""s,
         string overline = ""s, int font = 0, struct side_values padding = {0U,0U}, struct side_values margin = {0U,0U},
         size_t maxlen = 0_z, bool ellipsis = true, vector<token>&& tokens = {})
@@ -54,8 +56,9 @@ namespace drawtypes {
         , m_maxlen(maxlen)
         , m_ellipsis(ellipsis)
         , m_text(text)
-        , m_tokenized(m_text)
-        , m_tokens(forward<vector<token>>(tokens)) {}
+        , m_tokens(forward<vector<token>>(tokens)) {
+      compile(m_text);
+    }
 
     string get() const;
     operator bool();
@@ -69,9 +72,33 @@ namespace drawtypes {
     void copy_undefined(const label_t& label);
 
    private:
+    /**
+     * Literal text or token slot of the compiled label text
+     */
+    struct segment {
+      string text;
+      size_t token;
+      string value{};
+      bool replaced{false};
+    };
+
+    void compile(const string& text);
+
     string m_text{};
-    string m_tokenized{};
     const vector<token> m_tokens{};
+
+    /**
+     * Segments of the label text, token slots keep their replacement
+     * value until the tokens are reset
+     */
+    vector<segment> m_segments{};
+    bool m_custom{false};
+
+    /**
+     * Rendered text, rebuilt when a token slot has changed
+     */
+    mutable string m_tokenized{};
+    mutable bool m_dirty{true};
   };
 
   label_t load_label(const config& conf, const string& section, string name, bool required = true, string def = ""s);
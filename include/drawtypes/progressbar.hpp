@@ -25,7 +25,7 @@ namespace drawtypes {
     void set_gradient(bool mode);
     void set_colors(vector<string>&& colors);
 
-    string output(float percentage);
+    display_list output(float percentage);
 
    protected:
     void fill(unsigned int perc, unsigned int fill_width);
@@ -3,7 +3,6 @@
 #include "common.hpp"
 
 #include "components/ipc.hpp"
-#include "components/parser.hpp"
 #include "components/types.hpp"
 #include "utils/functional.hpp"
 
@@ -66,7 +65,7 @@ namespace signals {
     struct exit_reload : public detail::base_signal<exit_reload> {
       using base_type::base_type;
     };
-    struct notify_change : public detail::base_signal<notify_change> {
+    struct notify_change : public detail::value_signal<notify_change, string> {
       using base_type::base_type;
     };
     struct notify_forcechange : public detail::base_signal<notify_forcechange> {
@@ -124,48 +123,6 @@ namespace signals {
       using base_type::base_type;
     };
   }
-
-  namespace parser {
-    struct change_background : public detail::value_signal<change_background, unsigned int> {
-      using base_type::base_type;
-    };
-    struct change_foreground : public detail::value_signal<change_foreground, unsigned int> {
-      using base_type::base_type;
-    };
-    struct change_underline : public detail::value_signal<change_underline, unsigned int> {
-      using base_type::base_type;
-    };
-    struct change_overline : public detail::value_signal<change_overline, unsigned int> {
-      using base_type::base_type;
-    };
-    struct change_font : public detail::value_signal<change_font, int> {
-      using base_type::base_type;
-    };
-    struct change_alignment : public detail::value_signal<change_alignment, alignment> {
-      using base_type::base_type;
-    };
-    struct offset_pixel : public detail::value_signal<offset_pixel, int> {
-      using base_type::base_type;
-    };
-    struct attribute_set : public detail::value_signal<attribute_set, attribute> {
-      using base_type::base_type;
-    };
-    struct attribute_unset : public detail::value_signal<attribute_unset, attribute> {
-      using base_type::base_type;
-    };
-    struct attribute_toggle : public detail::value_signal<attribute_toggle, attribute> {
-      using base_type::base_type;
-    };
-    struct action_begin : public detail::value_signal<action_begin, action> {
-      using base_type::base_type;
-    };
-    struct action_end : public detail::value_signal<action_end, mousebtn> {
-      using base_type::base_type;
-    };
-    struct text : public detail::value_signal<text, string> {
-      using base_type::base_type;
-    };
-  }
 }
 
 POLYBAR_NS_END
@@ -1,18 +1,130 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
 #include "common.hpp"
 #include "events/signal_receiver.hpp"
 
 POLYBAR_NS
 
-/**
- * @brief Holds all signal receivers attached to the emitter
- */
-extern signal_receivers_t g_signal_receivers;
+namespace detail {
+  /**
+   * Receivers attached to a single signal type, sorted by priority
+   *
+   * Every signal type gets its own table, which means the lookup
+   * is resolved at compile time and the receivers can be stored as
+   * signal_receiver_impl<Signal> pointers, i.e. no runtime casts.
+   *
+   * The list is copy-on-write: attach/detach publish a new list
+   * while emitting holds a reference to the current one, so no lock
+   * is held while calling into the receivers. detach() keeps the
+   * replaced list and waits until the emits on other threads have
+   * released it, after which the receiver can safely be destroyed.
+   */
+  template <typename Signal>
+  class signal_table {
+   public:
+    using receiver_type = signal_receiver_impl<Signal>*;
+    using entry_type = std::pair<signal_receiver_interface::prio, receiver_type>;
+    using list_type = vector<entry_type>;
+
+    static shared_ptr<const list_type> enter() {
+      auto list = std::atomic_load(&s_list);
+      t_held.emplace_back(list.get());
+      return list;
+    }
+
+    static void leave(shared_ptr<const list_type>&& list) {
+      t_held.pop_back();
+      list.reset();
+
+      if (s_waiting > 0) {
+        std::lock_guard<std::mutex> guard(s_waitlock);
+        s_done.notify_all();
+      }
+    }
+
+    static void attach(signal_receiver_interface::prio priority, receiver_type receiver) {
+      std::lock_guard<std::mutex> guard(s_lock);
+      auto list = s_list ? make_shared<list_type>(*s_list) : make_shared<list_type>();
+      auto pos = std::upper_bound(list->begin(), list->end(), priority,
+          [](signal_receiver_interface::prio p, const entry_type& entry) { return p < entry.first; });
+      list->emplace(pos, priority, receiver);
+      std::atomic_store(&s_list, shared_ptr<const list_type>{move(list)});
+    }
+
+    static void detach(receiver_type receiver) {
+      shared_ptr<const list_type> replaced;
+      {
+        std::lock_guard<std::mutex> guard(s_lock);
+        if (!s_list) {
+          return;
+        }
+        auto list = make_shared<list_type>(*s_list);
+        list->erase(std::remove_if(list->begin(), list->end(),
+                        [receiver](const entry_type& entry) { return entry.second == receiver; }),
+            list->end());
+        replaced = std::atomic_exchange(&s_list, shared_ptr<const list_type>{move(list)});
+      }
+
+      // Emits that loaded the new list won't call the receiver. The ones
+      // running on the calling thread (i.e. the receiver detaching from
+      // within a handler) can't be waited for
+      long held{1 + std::count(t_held.begin(), t_held.end(), replaced.get())};
+
+      s_waiting++;
+      std::unique_lock<std::mutex> guard(s_waitlock);
+      while (replaced.use_count() > held) {
+        // use_count() isn't synchronized with the notification, don't rely on it alone
+        s_done.wait_for(guard, std::chrono::milliseconds{5});
+      }
+      s_waiting--;
+    }
+
+   private:
+    static std::mutex s_lock;
+    static shared_ptr<const list_type> s_list;
+
+    static std::atomic<int> s_waiting;
+    static std::mutex s_waitlock;
+    static std::condition_variable s_done;
+
+    /**
+     * Lists held by the emits running on this thread
+     */
+    static thread_local vector<const list_type*> t_held;
+  };
+
+  template <typename Signal>
+  std::mutex signal_table<Signal>::s_lock;
+
+  template <typename Signal>
+  shared_ptr<const typename signal_table<Signal>::list_type> signal_table<Signal>::s_list;
+
+  template <typename Signal>
+  std::atomic<int> signal_table<Signal>::s_waiting{0};
+
+  template <typename Signal>
+  std::mutex signal_table<Signal>::s_waitlock;
+
+  template <typename Signal>
+  std::condition_variable signal_table<Signal>::s_done;
+
+  template <typename Signal>
+  thread_local vector<const typename signal_table<Signal>::list_type*> signal_table<Signal>::t_held;
+}
 
 /**
  * Wrapper used to delegate emitted signals
  * to attached signal receivers
+ *
+ * Attaching, detaching and emitting is safe to do from any thread.
+ * Once detach() returns, the receiver won't be called anymore, except
+ * by emits that were already in flight on the detaching thread.
  */
 class signal_emitter {
  public:
@@ -23,17 +135,23 @@ class signal_emitter {
   virtual ~signal_emitter() {}
 
   template <typename Signal>
-  bool emit(const Signal& sig) {
+  bool emit(const Signal& sig) const {
+    auto receivers = detail::signal_table<Signal>::enter();
+    bool handled{false};
+
     try {
-      for (auto&& item : g_signal_receivers.at(id<Signal>())) {
-        if (item.second->on(sig)) {
-          return true;
+      if (receivers) {
+        for (auto&& entry : *receivers) {
+          if ((handled = entry.second->on(sig))) {
+            break;
+          }
         }
       }
     } catch (...) {
     }
 
-    return false;
+    detail::signal_table<Signal>::leave(move(receivers));
+    return handled;
   }
 
   template <typename Signal, typename Next, typename... Signals>
@@ -52,52 +170,27 @@ class signal_emitter {
   }
 
  protected:
-  template <typename Signal>
-  std::type_index id() const {
-    return typeid(Signal);
-  }
-
   template <typename Receiver, typename Signal>
   void attach(Receiver* s) {
-    attach(s, id<Signal>());
+    detail::signal_table<Signal>::attach(s->priority(), static_cast<signal_receiver_impl<Signal>*>(s));
   }
 
   template <typename Receiver, typename Signal, typename Next, typename... Signals>
   void attach(Receiver* s) {
-    attach(s, id<Signal>());
+    attach<Receiver, Signal>(s);
     attach<Receiver, Next, Signals...>(s);
   }
 
-  void attach(signal_receiver_interface* s, std::type_index id) {
-    g_signal_receivers[id].emplace(s->priority(), s);
-  }
-
   template <typename Receiver, typename Signal>
   void detach(Receiver* s) {
-    detach(s, id<Signal>());
+    detail::signal_table<Signal>::detach(static_cast<signal_receiver_impl<Signal>*>(s));
   }
 
   template <typename Receiver, typename Signal, typename Next, typename... Signals>
   void detach(Receiver* s) {
-    detach(s, id<Signal>());
+    detach<Receiver, Signal>(s);
     detach<Receiver, Next, Signals...>(s);
   }
-
-  void detach(signal_receiver_interface* d, std::type_index id) {
-    try {
-      auto& prio_map = g_signal_receivers.at(id);
-      const auto& prio_sink_pair = prio_map.equal_range(d->priority());
-
-      for (auto it = prio_sink_pair.first; it != prio_sink_pair.second;) {
-        if (d == it->second) {
-          it = prio_map.erase(it);
-        } else {
-          ++it;
-        }
-      }
-    } catch (...) {
-    }
-  }
 };
 
 POLYBAR_NS_END
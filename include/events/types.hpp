@@ -12,6 +12,7 @@ enum class event_type {
   CHECK,
   INPUT,
   QUIT,
+  COMMAND,
 };
 
 struct event {
@@ -54,6 +55,13 @@ namespace {
   inline event make_check_evt() {
     return event{static_cast<int>(event_type::CHECK)};
   }
+
+  /**
+   * Create COMMAND event, sent when a spawned command has finished
+   */
+  inline event make_command_evt() {
+    return event{static_cast<int>(event_type::COMMAND)};
+  }
 }
 
 POLYBAR_NS_END
@@ -20,15 +20,16 @@ namespace modules {
    public:
     explicit backlight_module(const bar_settings&, string);
 
-    void idle();
     bool on_event(inotify_event* event);
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    private:
     static constexpr auto TAG_LABEL = "<label>";
     static constexpr auto TAG_BAR = "<bar>";
     static constexpr auto TAG_RAMP = "<ramp>";
 
+    enum class tag { LABEL, BAR, RAMP };
+
     ramp_t m_ramp;
     label_t m_label;
     progressbar_t m_progressbar;
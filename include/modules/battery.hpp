@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.hpp"
+#include "components/scheduler.hpp"
 #include "modules/meta/inotify_module.hpp"
 
 POLYBAR_NS
@@ -47,17 +48,17 @@ namespace modules {
     explicit battery_module(const bar_settings&, string);
 
     void start();
-    void teardown();
-    void idle();
+    void stop();
+    bool on_timeout();
     bool on_event(inotify_event* event);
     string get_format() const;
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    protected:
     state current_state();
     int current_percentage(state state);
     string current_time();
-    void subthread();
+    void animate();
 
    private:
     static constexpr const char* FORMAT_CHARGING{"format-charging"};
@@ -71,6 +72,8 @@ namespace modules {
     static constexpr const char* TAG_LABEL_DISCHARGING{"<label-discharging>"};
     static constexpr const char* TAG_LABEL_FULL{"<label-full>"};
 
+    enum class tag { ANIMATION_CHARGING, BAR_CAPACITY, RAMP_CAPACITY, LABEL_CHARGING, LABEL_DISCHARGING, LABEL_FULL };
+
     static const size_t SKIP_N_UNCHANGED{3_z};
 
     unique_ptr<state_reader> m_state_reader;
@@ -97,8 +100,7 @@ namespace modules {
     string m_timeformat;
     size_t m_unchanged{SKIP_N_UNCHANGED};
     chrono::duration<double> m_interval{};
-    chrono::system_clock::time_point m_lastpoll;
-    thread m_subthread;
+    scheduler::timer_id m_animation_timer{0};
   };
 }
 
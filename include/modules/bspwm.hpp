@@ -42,10 +42,11 @@ namespace modules {
     explicit bspwm_module(const bar_settings&, string);
 
     void stop();
+    vector<struct pollfd> poll_descriptors();
     bool has_event();
     bool update();
-    string get_output();
-    bool build(builder* builder, const string& tag) const;
+    display_list get_output();
+    bool build(builder* builder, int id) const;
 
    protected:
     bool input(string&& cmd);
@@ -59,6 +60,8 @@ namespace modules {
     static constexpr auto TAG_LABEL_STATE = "<label-state>";
     static constexpr auto TAG_LABEL_MODE = "<label-mode>";
 
+    enum class tag { LABEL_MONITOR, LABEL_STATE, LABEL_MODE };
+
     static constexpr const char* EVENT_PREFIX{"bspwm-desk"};
     static constexpr const char* EVENT_CLICK{"bspwm-deskfocus"};
     static constexpr const char* EVENT_SCROLL_UP{"bspwm-desknext"};
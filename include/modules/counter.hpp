@@ -10,11 +10,13 @@ namespace modules {
     explicit counter_module(const bar_settings&, string);
 
     bool update();
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    private:
     static constexpr auto TAG_COUNTER = "<counter>";
 
+    enum class tag { COUNTER };
+
     int m_counter{0};
   };
 }
@@ -21,7 +21,7 @@ namespace modules {
     explicit cpu_module(const bar_settings&, string);
 
     bool update();
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    protected:
     bool read_values();
@@ -33,6 +33,8 @@ namespace modules {
     static constexpr auto TAG_RAMP_LOAD = "<ramp-load>";
     static constexpr auto TAG_RAMP_LOAD_PER_CORE = "<ramp-coreload>";
 
+    enum class tag { LABEL, BAR_LOAD, RAMP_LOAD, RAMP_LOAD_PER_CORE };
+
     progressbar_t m_barload;
     ramp_t m_rampload;
     ramp_t m_rampload_core;
@@ -11,7 +11,7 @@ namespace modules {
     explicit date_module(const bar_settings&, string);
 
     bool update();
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    protected:
     bool input(string&& cmd);
@@ -23,6 +23,8 @@ namespace modules {
     // @deprecated: Use <label>
     static constexpr auto TAG_DATE = "<date>";
 
+    enum class tag { LABEL, DATE };
+
     label_t m_label;
 
     string m_dateformat;
@@ -39,8 +39,8 @@ namespace modules {
 
     bool update();
     string get_format() const;
-    string get_output();
-    bool build(builder* builder, const string& tag) const;
+    display_list get_output();
+    bool build(builder* builder, int id) const;
 
    private:
     static constexpr auto FORMAT_MOUNTED = "format-mounted";
@@ -51,6 +51,8 @@ namespace modules {
     static constexpr auto TAG_BAR_FREE = "<bar-free>";
     static constexpr auto TAG_RAMP_CAPACITY = "<ramp-capacity>";
 
+    enum class tag { LABEL_MOUNTED, LABEL_UNMOUNTED, BAR_USED, BAR_FREE, RAMP_CAPACITY };
+
     label_t m_labelmounted;
     label_t m_labelunmounted;
     progressbar_t m_barused;
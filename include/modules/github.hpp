@@ -15,11 +15,14 @@ namespace modules {
     explicit github_module(const bar_settings&, string);
 
     bool update();
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
+    bool blocking() const;
 
    private:
     static constexpr auto TAG_LABEL = "<label>";
 
+    enum class tag { LABEL };
+
     label_t m_label{};
     string m_accesstoken{};
     unique_ptr<http_downloader> m_http{};
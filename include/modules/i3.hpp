@@ -48,9 +48,10 @@ namespace modules {
     explicit i3_module(const bar_settings&, string);
 
     void stop();
+    vector<struct pollfd> poll_descriptors();
     bool has_event();
     bool update();
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    protected:
     bool input(string&& cmd);
@@ -64,6 +65,8 @@ namespace modules {
     static constexpr const char* TAG_LABEL_STATE{"<label-state>"};
     static constexpr const char* TAG_LABEL_MODE{"<label-mode>"};
 
+    enum class tag { LABEL_STATE, LABEL_MODE };
+
     static constexpr const char* EVENT_PREFIX{"i3wm"};
     static constexpr const char* EVENT_CLICK{"i3wm-wsfocus-"};
     static constexpr const char* EVENT_SCROLL_UP{"i3wm-wsnext"};
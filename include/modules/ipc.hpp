@@ -30,12 +30,14 @@ namespace modules {
 
     void start();
     void update() {}
-    string get_output();
-    bool build(builder* builder, const string& tag) const;
+    display_list get_output();
+    bool build(builder* builder, int id) const;
     void on_message(const string& message);
 
    private:
     static constexpr const char* TAG_OUTPUT{"<output>"};
+
+    enum class tag { OUTPUT };
     vector<unique_ptr<hook>> m_hooks;
     map<mousebtn, string> m_actions;
     string m_output;
@@ -13,13 +13,15 @@ namespace modules {
     explicit memory_module(const bar_settings&, string);
 
     bool update();
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    private:
     static constexpr const char* TAG_LABEL{"<label>"};
     static constexpr const char* TAG_BAR_USED{"<bar-used>"};
     static constexpr const char* TAG_BAR_FREE{"<bar-free>"};
 
+    enum class tag { LABEL, BAR_USED, BAR_FREE };
+
     label_t m_label;
     progressbar_t m_bar_memused;
     progressbar_t m_bar_memfree;
@@ -20,7 +20,7 @@ namespace modules {
    public:
     explicit menu_module(const bar_settings&, string);
 
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
     void update() {}
 
    protected:
@@ -30,6 +30,8 @@ namespace modules {
     static constexpr auto TAG_LABEL_TOGGLE = "<label-toggle>";
     static constexpr auto TAG_MENU = "<menu>";
 
+    enum class tag { LABEL_TOGGLE, MENU };
+
     static constexpr auto EVENT_MENU_OPEN = "menu-open-";
     static constexpr auto EVENT_MENU_CLOSE = "menu-close";
 
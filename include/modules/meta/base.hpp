@@ -57,11 +57,36 @@ namespace modules {
   DEFINE_CHILD_ERROR(undefined_format, module_error);
   DEFINE_CHILD_ERROR(undefined_format_tag, module_error);
 
+  // class definition : format_tag {{{
+
+  /**
+   * Format tag and the id passed to `build()` when it gets rendered
+   */
+  struct format_tag {
+    template <typename Id>
+    format_tag(string name, Id id) : name(move(name)), id(static_cast<int>(id)) {}
+
+    string name;
+    int id;
+  };
+
+  // }}}
   // class definition : module_format {{{
 
   struct module_format {
+    static constexpr int LITERAL{-1};
+
+    /**
+     * Literal text or format tag of the compiled format string
+     */
+    struct segment {
+      string text;
+      int tag;
+    };
+
     string value{};
-    vector<string> tags{};
+    vector<segment> segments{};
+    vector<format_tag> tags{};
     label_t prefix{};
     label_t suffix{};
     string fg{};
@@ -75,7 +100,8 @@ namespace modules {
     size_t margin{0};
     int offset{0};
 
-    string decorate(builder* builder, string output);
+    void compile();
+    display_list decorate(builder* builder, display_list output);
   };
 
   // }}}
@@ -85,7 +111,7 @@ namespace modules {
    public:
     explicit module_formatter(const config& conf, string modname) : m_conf(conf), m_modname(modname) {}
 
-    void add(string name, string fallback, vector<string>&& tags, vector<string>&& whitelist = {});
+    void add(string name, string fallback, vector<format_tag>&& tags, vector<format_tag>&& whitelist = {});
     bool has(const string& tag, const string& format_name);
     bool has(const string& tag);
     shared_ptr<module_format> get(const string& format_name);
@@ -110,7 +136,8 @@ namespace modules {
     virtual void start() = 0;
     virtual void stop() = 0;
     virtual void halt(string error_message) = 0;
-    virtual string contents() = 0;
+    virtual display_list contents() = 0;
+    virtual size_t suppressed_updates() const = 0;
   };
 
   // }}}
@@ -127,7 +154,8 @@ namespace modules {
     void stop();
     void halt(string error_message);
     void teardown();
-    string contents();
+    display_list contents();
+    size_t suppressed_updates() const;
 
    protected:
     void broadcast();
@@ -135,7 +163,7 @@ namespace modules {
     void sleep(chrono::duration<double> duration);
     void wakeup();
     string get_format() const;
-    string get_output();
+    display_list get_output();
 
    protected:
     signal_emitter& m_sig;
@@ -145,6 +173,7 @@ namespace modules {
 
     mutex m_buildlock;
     mutex m_updatelock;
+    mutex m_outputlock;
     mutex m_sleeplock;
     std::condition_variable m_sleephandler;
 
@@ -156,8 +185,17 @@ namespace modules {
 
    private:
     atomic<bool> m_enabled{true};
-    atomic<bool> m_changed{true};
-    string m_cache;
+
+    /**
+     * Latest output, built on the thread calling `broadcast()` and
+     * swapped atomically so that `contents()` never waits for the module
+     */
+    shared_ptr<const display_list> m_output;
+
+    /**
+     * Number of broadcasts dropped because the output didn't change
+     */
+    atomic<size_t> m_suppressed{0};
   };
 
   // }}}
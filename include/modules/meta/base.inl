@@ -50,6 +50,7 @@ namespace modules {
     }
 
     m_log.info("%s: Stopping", name());
+    m_log.info("%s: Suppressed %lu redundant updates", name(), suppressed_updates());
     m_enabled = false;
 
     std::lock(m_buildlock, m_updatelock);
@@ -74,13 +75,17 @@ namespace modules {
   void module<Impl>::teardown() {}
 
   template <typename Impl>
-  string module<Impl>::contents() {
-    if (m_changed) {
-      m_log.info("%s: Rebuilding cache", name());
-      m_cache = CAST_MOD(Impl)->get_output();
-      m_changed = false;
-    }
-    return m_cache;
+  display_list module<Impl>::contents() {
+    auto output = std::atomic_load(&m_output);
+    return output ? *output : display_list{};
+  }
+
+  /**
+   * Get the number of broadcasts dropped because the output didn't change
+   */
+  template <typename Impl>
+  size_t module<Impl>::suppressed_updates() const {
+    return m_suppressed.load();
   }
 
   // }}}
@@ -88,8 +93,21 @@ namespace modules {
 
   template <typename Impl>
   void module<Impl>::broadcast() {
-    m_changed = true;
-    m_sig.emit(signals::eventqueue::notify_change{});
+    {
+      // Serialize builds so that an older output can't replace a newer one
+      std::lock_guard<std::mutex> guard(m_outputlock);
+      m_log.info("%s: Rebuilding cache", name());
+      auto output = std::make_shared<const display_list>(CAST_MOD(Impl)->get_output());
+
+      // Only notify the controller if the output actually changed
+      if (m_output && *m_output == *output) {
+        m_log.trace("%s: Output unchanged, suppressing update (total: %lu)", name(), ++m_suppressed);
+        return;
+      }
+
+      std::atomic_store(&m_output, output);
+    }
+    m_sig.emit(signals::eventqueue::notify_change{string{m_name}});
   }
 
   template <typename Impl>
@@ -119,52 +137,35 @@ namespace modules {
   }
 
   template <typename Impl>
-  string module<Impl>::get_output() {
+  display_list module<Impl>::get_output() {
     std::lock_guard<std::mutex> guard(m_buildlock);
     auto format_name = CONST_MOD(Impl).get_format();
     auto format = m_formatter->get(format_name);
     bool no_tag_built{true};
-    bool fake_no_tag_built{false};
     bool tag_built{false};
     auto mingap = std::max(1_z, format->spacing);
-    size_t start, end;
-    string value{format->value};
-    while ((start = value.find('<')) != string::npos && (end = value.find('>', start)) != string::npos) {
-      if (start > 0) {
-        if (no_tag_built) {
-          // If no module tag has been built we do not want to add
-          // whitespace defined between the format tags, but we do still
-          // want to output other non-tag content
-          auto trimmed = string_util::ltrim(value.substr(0, start), ' ');
-          if (!trimmed.empty()) {
-            fake_no_tag_built = false;
-            m_builder->node(move(trimmed));
-          }
-        } else {
-          m_builder->node(value.substr(0, start));
-        }
-        value.erase(0, start);
-        end -= start;
-        start = 0;
-      }
-      string tag{value.substr(start, end + 1)};
-      if (tag.empty()) {
-        continue;
-      } else if (tag[0] == '<' && tag[tag.size() - 1] == '>') {
+
+    for (auto it = format->segments.begin(); it != format->segments.end(); ++it) {
+      if (it->tag != module_format::LITERAL) {
         if (!no_tag_built)
           m_builder->space(format->spacing);
-        else if (fake_no_tag_built)
-          no_tag_built = false;
-        if (!(tag_built = CONST_MOD(Impl).build(m_builder.get(), tag)) && !no_tag_built)
+        if (!(tag_built = CONST_MOD(Impl).build(m_builder.get(), it->tag)) && !no_tag_built)
           m_builder->remove_trailing_space(mingap);
         if (tag_built)
           no_tag_built = false;
+      } else if (it + 1 == format->segments.end()) {
+        m_builder->append(it->text);
+      } else if (no_tag_built) {
+        // If no module tag has been built we do not want to add
+        // whitespace defined between the format tags, but we do still
+        // want to output other non-tag content
+        auto trimmed = string_util::ltrim(string{it->text}, ' ');
+        if (!trimmed.empty()) {
+          m_builder->node(move(trimmed));
+        }
+      } else {
+        m_builder->node(it->text);
       }
-      value.erase(0, tag.size());
-    }
-
-    if (!value.empty()) {
-      m_builder->append(value);
     }
 
     return format->decorate(&*m_builder, m_builder->flush());
@@ -1,19 +1,58 @@
 #pragma once
 
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
 
 namespace modules {
+  /**
+   * Module updated when its event source reports an event
+   *
+   * Modules that expose the descriptors of their event source through
+   * `poll_descriptors()` sleep in poll(2) until one of them is ready or
+   * `poll_timeout()` expires. Modules returning no descriptors call
+   * `has_event()` between calls to `idle()` instead, as do modules whose
+   * descriptors report a hangup or an error and wakes that yield no event.
+   */
   template <class Impl>
   class event_module : public module<Impl> {
    public:
     using module<Impl>::module;
 
+    ~event_module() {
+      if (m_wakeupfd != -1) {
+        close(m_wakeupfd);
+      }
+    }
+
     void start() {
+      if ((m_wakeupfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) {
+        throw module_error("Failed to create wakeup channel");
+      }
       this->m_mainthread = thread(&event_module::runner, this);
     }
 
+    void wakeup() {
+      module<Impl>::wakeup();
+
+      uint64_t value{1};
+      if (m_wakeupfd != -1 && write(m_wakeupfd, &value, sizeof(value)) == -1) {
+        this->m_log.err("%s: Failed to interrupt event wait", this->name());
+      }
+    }
+
+    vector<struct pollfd> poll_descriptors() {
+      return {};
+    }
+
+    int poll_timeout() {
+      return -1;
+    }
+
    protected:
     void runner() {
       this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
@@ -30,15 +69,66 @@ namespace modules {
         };
 
         while (this->running()) {
-          if (check()) {
-            CAST_MOD(Impl)->broadcast();
+          auto fds = CAST_MOD(Impl)->poll_descriptors();
+
+          if (fds.empty()) {
+            if (check()) {
+              CAST_MOD(Impl)->broadcast();
+            }
+            CAST_MOD(Impl)->idle();
+          } else {
+            bool failed{!wait_descriptors(fds, CAST_MOD(Impl)->poll_timeout())};
+
+            if (!this->running()) {
+              break;
+            }
+
+            bool updated{check()};
+            if (updated) {
+              CAST_MOD(Impl)->broadcast();
+            }
+            // a descriptor stuck in hangup or error stays ready, so back off like the polling path
+            if (!updated || failed) {
+              CAST_MOD(Impl)->idle();
+            }
           }
-          CAST_MOD(Impl)->idle();
         }
       } catch (const exception& err) {
         CAST_MOD(Impl)->halt(err.what());
       }
     }
+
+    /**
+     * Wait until one of the descriptors is ready or the wait gets interrupted
+     *
+     * @return false if one of the module descriptors reported a hangup or an error
+     */
+    bool wait_descriptors(vector<struct pollfd>& fds, int timeout_ms) {
+      fds.push_back({m_wakeupfd, POLLIN, 0});
+
+      if (::poll(fds.data(), fds.size(), timeout_ms) == -1 && errno != EINTR) {
+        throw module_error("Failed to poll event descriptors (" + string{strerror(errno)} + ")");
+      }
+
+      if (fds.back().revents & POLLIN) {
+        uint64_t count;
+        while (read(m_wakeupfd, &count, sizeof(count)) > 0) {
+          ;
+        }
+      }
+
+      for (auto it = fds.begin(); it != fds.end() - 1; ++it) {
+        if (it->revents & (POLLHUP | POLLERR | POLLNVAL)) {
+          this->m_log.trace("%s: Event descriptor %i reported %i", this->name(), it->fd, it->revents);
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+   private:
+    int m_wakeupfd{-1};
   };
 }
 
@@ -102,6 +102,22 @@ namespace {
       throw application_error("Unknown module: " + name);
     }
   }
+
+  /**
+   * Check if given module type needs a connection to the X server
+   */
+  bool module_requires_x(const string& name) {
+    return name == "internal/systray" || name == "internal/xbacklight" || name == "internal/xkeyboard" ||
+           name == "internal/xwindow" || name == "internal/xworkspaces";
+  }
+
+  /**
+   * Check if the output of given module type depends on the monitor of the bar
+   */
+  bool module_binds_monitor(const string& name) {
+    return name == "internal/i3" || name == "internal/bspwm" || name == "internal/xbacklight" ||
+           name == "internal/xworkspaces";
+  }
 }
 
 POLYBAR_NS_END
@@ -1,92 +1,174 @@
 #pragma once
 
 #include "components/builder.hpp"
+#include "components/inotify_dispatcher.hpp"
+#include "components/scheduler.hpp"
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
 
 namespace modules {
+  /**
+   * Module updated when one of its watched files changes
+   *
+   * The watches are registered with the shared inotify dispatcher and
+   * events are handled on the shared scheduler. Events reported while
+   * handling the previous one, or within `m_cooldown` after it, are
+   * dropped because reading the watched files can fire events of its
+   * own. If `m_timeout` is set, `on_timeout()` gets called when no
+   * event has been handled for that long.
+   */
   template <class Impl>
   class inotify_module : public module<Impl> {
    public:
     using module<Impl>::module;
 
+    ~inotify_module() {
+      unsubscribe();
+      if (m_timer) {
+        scheduler::make().remove(m_timer);
+      }
+    }
+
     void start() {
-      this->m_mainthread = thread(&inotify_module::runner, this);
+      m_timer = scheduler::make().add([this] { process(); });
+      subscribe();
+      scheduler::make().arm(m_timer, 0ms);
     }
 
-   protected:
-    void runner() {
-      this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
-      try {
-        // Warm up module output before entering the loop
-        std::unique_lock<std::mutex> guard(this->m_updatelock);
-        CAST_MOD(Impl)->on_event(nullptr);
-        CAST_MOD(Impl)->broadcast();
-        guard.unlock();
-
-        while (this->running()) {
-          std::lock_guard<std::mutex> guard(this->m_updatelock);
-          CAST_MOD(Impl)->poll_events();
-        }
-      } catch (const module_error& err) {
-        CAST_MOD(Impl)->halt(err.what());
-      } catch (const std::exception& err) {
-        CAST_MOD(Impl)->halt(err.what());
+    /**
+     * Drop the timer and the watches before stopping, this waits for a running handler
+     */
+    void stop() {
+      if (m_timer) {
+        scheduler::make().remove(m_timer);
       }
+      unsubscribe();
+      module<Impl>::stop();
+    }
+
+    bool on_timeout() {
+      return false;
     }
 
+   protected:
     void watch(string path, int mask = IN_ALL_EVENTS) {
       this->m_log.trace("%s: Attach inotify at %s", this->name(), path);
       m_watchlist.insert(make_pair(path, mask));
     }
 
-    void idle() {
-      this->sleep(200ms);
-    }
-
-    void poll_events() {
-      vector<unique_ptr<inotify_watch>> watches;
-
+    bool subscribe() {
       try {
         for (auto&& w : m_watchlist) {
-          watches.emplace_back(inotify_util::make_watch(w.first));
-          watches.back()->attach(w.second);
+          m_subscriptions.emplace_back(inotify_dispatcher::make().add(
+              w.first, w.second, [this](const inotify_event& event) { notify(event); }));
         }
+        return true;
       } catch (const system_error& e) {
-        watches.clear();
+        unsubscribe();
         this->m_log.err("%s: Error while creating inotify watch (what: %s)", this->name(), e.what());
-        CAST_MOD(Impl)->sleep(0.1s);
+        return false;
+      }
+    }
+
+    void unsubscribe() {
+      for (auto&& id : m_subscriptions) {
+        inotify_dispatcher::make().remove(id);
+      }
+      m_subscriptions.clear();
+    }
+
+    /**
+     * Queue the event to be handled on the scheduler
+     *
+     * @note Invoked from the thread running the event loop
+     */
+    void notify(const inotify_event& event) {
+      std::lock_guard<std::mutex> guard(m_eventlock);
+
+      if (m_handling || chrono::steady_clock::now() < m_quiet_until) {
+        return;
+      } else if (m_pending) {
+        m_pending->mask |= event.mask;
+      } else {
+        m_pending = make_unique<inotify_event>(event);
+        scheduler::make().arm(m_timer, 0ms);
+      }
+    }
+
+    void process() {
+      if (!this->running()) {
         return;
       }
 
-      while (this->running()) {
-        for (auto&& w : watches) {
-          this->m_log.trace_x("%s: Poll inotify watch %s", this->name(), w->path());
+      std::unique_lock<std::mutex> guard(m_eventlock);
+      unique_ptr<inotify_event> event{move(m_pending)};
+      m_handling = true;
+      guard.unlock();
 
-          if (w->poll(1000 / watches.size())) {
-            auto event = w->get_event();
+      try {
+        if (m_subscriptions.empty()) {
+          subscribe();
+        }
 
-            for (auto&& w : watches) {
-              w->remove(true);
-            }
+        std::unique_lock<std::mutex> update_guard(this->m_updatelock);
+        bool changed{true};
+
+        if (!m_warm) {
+          // Warm up module output
+          CAST_MOD(Impl)->on_event(nullptr);
+          m_warm = true;
+        } else if (event) {
+          changed = CAST_MOD(Impl)->on_event(event.get());
+        } else {
+          changed = CAST_MOD(Impl)->on_timeout();
+        }
 
-            if (CAST_MOD(Impl)->on_event(event.get())) {
-              CAST_MOD(Impl)->broadcast();
-            }
-            CAST_MOD(Impl)->idle();
-            return;
-          }
+        update_guard.unlock();
 
-          if (!this->running())
-            break;
+        if (changed) {
+          CAST_MOD(Impl)->broadcast();
         }
-        CAST_MOD(Impl)->idle();
+      } catch (const std::exception& err) {
+        CAST_MOD(Impl)->halt(err.what());
+        return;
+      }
+
+      guard.lock();
+      m_handling = false;
+      m_quiet_until = chrono::steady_clock::now() + m_cooldown;
+      guard.unlock();
+
+      if (!this->running()) {
+        return;
+      } else if (m_subscriptions.empty()) {
+        scheduler::make().arm(m_timer, 1s);
+      } else if (m_timeout.count() > 0) {
+        scheduler::make().arm(m_timer, m_timeout);
       }
     }
 
+   protected:
+    /**
+     * Time after handling an event during which new events are dropped
+     */
+    scheduler::duration m_cooldown{200};
+
+    /**
+     * Call `on_timeout()` if no event has been handled for this long
+     */
+    scheduler::duration m_timeout{0};
+
    private:
     map<string, int> m_watchlist;
+    vector<inotify_dispatcher::subscription_id> m_subscriptions;
+    scheduler::timer_id m_timer{0};
+
+    std::mutex m_eventlock;
+    unique_ptr<inotify_event> m_pending;
+    chrono::steady_clock::time_point m_quiet_until;
+    bool m_handling{false};
+    bool m_warm{false};
   };
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "components/scheduler.hpp"
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
@@ -10,17 +11,36 @@ namespace modules {
    public:
     using module<Impl>::module;
 
+    ~static_module() {
+      if (m_timer) {
+        scheduler::make().remove(m_timer);
+      }
+    }
+
     void start() {
-      this->m_mainthread = thread([&] {
-        this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
+      m_timer = scheduler::make().add([this] {
         CAST_MOD(Impl)->update();
         CAST_MOD(Impl)->broadcast();
       });
+      scheduler::make().arm(m_timer, 0ms);
     }
 
-    bool build(builder*, string) const {
+    /**
+     * Remove the timer before stopping, this waits for a running update
+     */
+    void stop() {
+      if (m_timer) {
+        scheduler::make().remove(m_timer);
+      }
+      module<Impl>::stop();
+    }
+
+    bool build(builder*, int) const {
       return true;
     }
+
+   private:
+    scheduler::timer_id m_timer{0};
   };
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "components/scheduler.hpp"
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
@@ -7,24 +8,63 @@ POLYBAR_NS
 namespace modules {
   using interval_t = chrono::duration<double>;
 
+  /**
+   * Module updated at a fixed interval
+   *
+   * Updates run on the shared scheduler. Modules whose update can block
+   * for a long time (network requests, external commands) opt into a
+   * dedicated thread by defining `blocking()`.
+   */
   template <class Impl>
   class timer_module : public module<Impl> {
    public:
     using module<Impl>::module;
 
+    ~timer_module() {
+      if (m_timer) {
+        scheduler::make().remove(m_timer);
+      }
+    }
+
     void start() {
-      this->m_mainthread = thread(&timer_module::runner, this);
+      if (CONST_MOD(Impl).blocking()) {
+        this->m_mainthread = thread(&timer_module::runner, this);
+      } else {
+        m_timer = scheduler::make().add([this] { scheduled(); });
+        scheduler::make().arm(m_timer, 0ms);
+      }
+    }
+
+    /**
+     * Remove the timer before stopping, this waits for a running update
+     */
+    void stop() {
+      if (m_timer) {
+        scheduler::make().remove(m_timer);
+      }
+      module<Impl>::stop();
+    }
+
+    void wakeup() {
+      module<Impl>::wakeup();
+      if (m_timer && this->running()) {
+        scheduler::make().arm(m_timer, 0ms);
+      }
+    }
+
+    bool blocking() const {
+      return false;
     }
 
    protected:
+    bool check() {
+      std::unique_lock<std::mutex> guard(this->m_updatelock);
+      return CAST_MOD(Impl)->update();
+    }
+
     void runner() {
       this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
 
-      const auto check = [&]() -> bool {
-        std::unique_lock<std::mutex> guard(this->m_updatelock);
-        return CAST_MOD(Impl)->update();
-      };
-
       try {
         // warm up module output before entering the loop
         check();
@@ -41,8 +81,33 @@ namespace modules {
       }
     }
 
+    void scheduled() {
+      if (!this->running()) {
+        return;
+      }
+
+      try {
+        // the first update warms up the module output
+        if (check() || !m_warm) {
+          m_warm = true;
+          CAST_MOD(Impl)->broadcast();
+        }
+      } catch (const exception& err) {
+        CAST_MOD(Impl)->halt(err.what());
+        return;
+      }
+
+      if (this->running()) {
+        scheduler::make().arm(m_timer, chrono::duration_cast<scheduler::duration>(m_interval));
+      }
+    }
+
    protected:
     interval_t m_interval{1.0};
+
+   private:
+    scheduler::timer_id m_timer{0};
+    bool m_warm{false};
   };
 }
 
@@ -18,11 +18,13 @@ namespace modules {
     void teardown();
     inline bool connected() const;
     void idle();
+    vector<struct pollfd> poll_descriptors();
+    int poll_timeout();
     bool has_event();
     bool update();
     string get_format() const;
-    string get_output();
-    bool build(builder* builder, const string& tag) const;
+    display_list get_output();
+    bool build(builder* builder, int id) const;
 
    protected:
     bool input(string&& cmd);
@@ -48,6 +50,25 @@ namespace modules {
     static constexpr const char* FORMAT_OFFLINE{"format-offline"};
     static constexpr const char* TAG_LABEL_OFFLINE{"<label-offline>"};
 
+    enum class tag {
+      BAR_PROGRESS,
+      TOGGLE,
+      TOGGLE_STOP,
+      LABEL_SONG,
+      LABEL_TIME,
+      ICON_RANDOM,
+      ICON_REPEAT,
+      ICON_REPEAT_ONE,
+      ICON_PREV,
+      ICON_STOP,
+      ICON_PLAY,
+      ICON_PAUSE,
+      ICON_NEXT,
+      ICON_SEEKB,
+      ICON_SEEKF,
+      LABEL_OFFLINE,
+    };
+
     static constexpr const char* EVENT_PLAY{"mpdplay"};
     static constexpr const char* EVENT_PAUSE{"mpdpause"};
     static constexpr const char* EVENT_STOP{"mpdstop"};
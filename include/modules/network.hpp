@@ -13,13 +13,15 @@ namespace modules {
    public:
     explicit network_module(const bar_settings&, string);
 
+    void stop();
     void teardown();
     bool update();
     string get_format() const;
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
+    bool blocking() const;
 
    protected:
-    void subthread_routine();
+    void animate();
 
    private:
     static constexpr auto FORMAT_CONNECTED = "format-connected";
@@ -32,6 +34,15 @@ namespace modules {
     static constexpr auto TAG_LABEL_PACKETLOSS = "<label-packetloss>";
     static constexpr auto TAG_ANIMATION_PACKETLOSS = "<animation-packetloss>";
 
+    enum class tag {
+      RAMP_SIGNAL,
+      RAMP_QUALITY,
+      LABEL_CONNECTED,
+      LABEL_DISCONNECTED,
+      LABEL_PACKETLOSS,
+      ANIMATION_PACKETLOSS,
+    };
+
     net::wired_t m_wired;
     net::wireless_t m_wireless;
 
@@ -51,6 +62,8 @@ namespace modules {
     int m_ping_nth_update{0};
     int m_udspeed_minwidth{0};
     bool m_accumulate{false};
+
+    scheduler::timer_id m_animation_timer{0};
   };
 }
 
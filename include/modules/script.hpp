@@ -1,30 +1,39 @@
 #pragma once
 
 #include "modules/meta/base.hpp"
+#include "modules/meta/input_handler.hpp"
 #include "utils/command.hpp"
 #include "utils/io.hpp"
 
 POLYBAR_NS
 
 namespace modules {
-  class script_module : public module<script_module> {
+  class script_module : public module<script_module>, public input_handler {
    public:
     explicit script_module(const bar_settings&, string);
-    ~script_module() {}
+    ~script_module();
 
     void start();
     void stop();
 
-    string get_output();
-    bool build(builder* builder, const string& tag) const;
+    display_list get_output();
+    bool build(builder* builder, int id) const;
+    bool input(string&& cmd);
 
    protected:
     chrono::duration<double> process(const mutex_wrapper<function<chrono::duration<double>()>>& handler) const;
     bool check_condition();
+    bool wait_readable(int fd, int timeout_ms);
+    bool read_lines(int fd);
+    void send_input(chrono::steady_clock::time_point deadline);
+    bool write_input(int fd, int output_fd, chrono::steady_clock::time_point deadline);
 
    private:
     static constexpr const char* TAG_LABEL{"<label>"};
 
+    enum class tag { LABEL };
+    static constexpr const char* EVENT_CLICK{"scriptclick:"};
+
     mutex_wrapper<function<chrono::duration<double>()>> m_handler;
 
     unique_ptr<command> m_command;
@@ -41,6 +50,32 @@ namespace modules {
     int m_counter{0};
 
     bool m_stopping{false};
+
+    /**
+     * @brief Keep the command running and request each update over its stdin
+     */
+    bool m_coprocess{false};
+
+    /**
+     * @brief Interrupts the wait for command output
+     */
+    int m_wakeupfd{-1};
+
+    /**
+     * @brief Command output not terminated by a newline yet
+     */
+    string m_buffer;
+
+    /**
+     * @brief Messages waiting to be written to the co-process
+     */
+    vector<string> m_input;
+    mutex m_inputlock;
+
+    /**
+     * @brief Part of the messages that the co-process has not accepted yet
+     */
+    string m_pending;
   };
 }
 
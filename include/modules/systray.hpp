@@ -18,7 +18,7 @@ namespace modules {
     explicit systray_module(const bar_settings&, string);
 
     void update();
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    protected:
     bool input(string&& cmd);
@@ -29,6 +29,8 @@ namespace modules {
     static constexpr const char* TAG_LABEL_TOGGLE{"<label-toggle>"};
     static constexpr const char* TAG_TRAY_CLIENTS{"<tray-clients>"};
 
+    enum class tag { LABEL_TOGGLE, TRAY_CLIENTS };
+
     connection& m_connection;
     label_t m_label;
 
@@ -16,12 +16,14 @@ namespace modules {
 
     bool update();
     string get_format() const;
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    private:
     static constexpr auto TAG_LABEL = "<label>";
     static constexpr auto TAG_LABEL_WARN = "<label-warn>";
     static constexpr auto TAG_RAMP = "<ramp>";
+
+    enum class tag { LABEL, LABEL_WARN, RAMP };
     static constexpr auto FORMAT_WARN = "format-warn";
 
     map<temp_state, label_t> m_label;
@@ -26,8 +26,11 @@ namespace modules {
     void start() {}                                                                     \
     void stop() {}                                                                      \
     void halt(string) {}                                                                \
-    string contents() {                                                                 \
-      return "";                                                                        \
+    display_list contents() {                                                           \
+      return {};                                                                        \
+    }                                                                                   \
+    size_t suppressed_updates() const {                                                 \
+      return 0;                                                                         \
     }                                                                                   \
   }
 
@@ -24,11 +24,12 @@ namespace modules {
     explicit volume_module(const bar_settings&, string);
 
     void teardown();
+    vector<struct pollfd> poll_descriptors();
     bool has_event();
     bool update();
     string get_format() const;
-    string get_output();
-    bool build(builder* builder, const string& tag) const;
+    display_list get_output();
+    bool build(builder* builder, int id) const;
 
    protected:
     bool input(string&& cmd);
@@ -43,6 +44,8 @@ namespace modules {
     static constexpr auto TAG_LABEL_VOLUME = "<label-volume>";
     static constexpr auto TAG_LABEL_MUTED = "<label-muted>";
 
+    enum class tag { RAMP_VOLUME, BAR_VOLUME, LABEL_VOLUME, LABEL_MUTED };
+
     static constexpr auto EVENT_PREFIX = "vol";
     static constexpr auto EVENT_VOLUME_UP = "volup";
     static constexpr auto EVENT_VOLUME_DOWN = "voldown";
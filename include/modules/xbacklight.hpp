@@ -32,8 +32,8 @@ namespace modules {
     explicit xbacklight_module(const bar_settings& bar, string name_);
 
     void update();
-    string get_output();
-    bool build(builder* builder, const string& tag) const;
+    display_list get_output();
+    bool build(builder* builder, int id) const;
 
    protected:
     void handle(const evt::randr_notify& evt);
@@ -44,6 +44,8 @@ namespace modules {
     static constexpr const char* TAG_BAR{"<bar>"};
     static constexpr const char* TAG_RAMP{"<ramp>"};
 
+    enum class tag { LABEL, BAR, RAMP };
+
     static constexpr const char* EVENT_SCROLLUP{"xbacklight+"};
     static constexpr const char* EVENT_SCROLLDOWN{"xbacklight-"};
 
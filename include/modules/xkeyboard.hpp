@@ -24,9 +24,9 @@ namespace modules {
    public:
     explicit xkeyboard_module(const bar_settings& bar, string name_);
 
-    string get_output();
+    display_list get_output();
     void update();
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    protected:
     bool query_keyboard();
@@ -41,6 +41,8 @@ namespace modules {
    private:
     static constexpr const char* TAG_LABEL_LAYOUT{"<label-layout>"};
     static constexpr const char* TAG_LABEL_INDICATOR{"<label-indicator>"};
+
+    enum class tag { LABEL_LAYOUT, LABEL_INDICATOR };
     static constexpr const char* FORMAT_DEFAULT{"<label-layout> <label-indicator>"};
 
     static constexpr const char* EVENT_SWITCH{"xkeyboard/switch"};
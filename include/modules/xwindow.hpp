@@ -33,7 +33,7 @@ namespace modules {
     explicit xwindow_module(const bar_settings&, string);
 
     void update(bool force = false);
-    bool build(builder* builder, const string& tag) const;
+    bool build(builder* builder, int id) const;
 
    protected:
     void handle(const evt::property_notify& evt);
@@ -41,6 +41,8 @@ namespace modules {
    private:
     static constexpr const char* TAG_LABEL{"<label>"};
 
+    enum class tag { LABEL };
+
     connection& m_connection;
     unique_ptr<active_window> m_active;
     label_t m_label;
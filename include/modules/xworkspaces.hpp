@@ -57,8 +57,8 @@ namespace modules {
     explicit xworkspaces_module(const bar_settings& bar, string name_);
 
     void update();
-    string get_output();
-    bool build(builder* builder, const string& tag) const;
+    display_list get_output();
+    bool build(builder* builder, int id) const;
 
    protected:
     void handle(const evt::property_notify& evt);
@@ -77,6 +77,8 @@ namespace modules {
     static constexpr const char* TAG_LABEL_MONITOR{"<label-monitor>"};
     static constexpr const char* TAG_LABEL_STATE{"<label-state>"};
 
+    enum class tag { LABEL_MONITOR, LABEL_STATE };
+
     static constexpr const char* EVENT_PREFIX{"xworkspaces-"};
     static constexpr const char* EVENT_CLICK{"focus="};
     static constexpr const char* EVENT_SCROLL_UP{"next"};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <list>
 #include <unordered_map>
 
 #include "common.hpp"
@@ -32,4 +33,83 @@ class cache {
   safe_map_type m_cache;
 };
 
+/**
+ * Fixed size cache evicting the least recently used entry
+ *
+ * A capacity of 0 disables the cache: lookups always miss and only
+ * the value returned by the last insert is kept alive.
+ *
+ * Not thread-safe, the owner is expected to serialize access
+ */
+template <typename KeyType, typename ValueType>
+class lru_cache {
+ public:
+  using entry_type = std::pair<KeyType, ValueType>;
+  using list_type = std::list<entry_type>;
+  using map_type = std::unordered_map<KeyType, typename list_type::iterator>;
+
+  explicit lru_cache(size_t capacity) : m_capacity(capacity) {}
+
+  /**
+   * Get the cached value for given key and mark it as most recently used
+   *
+   * @return nullptr if the key is not cached
+   */
+  ValueType* find(const KeyType& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end() || !m_capacity) {
+      m_misses++;
+      return nullptr;
+    }
+    m_hits++;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return &it->second->second;
+  }
+
+  /**
+   * Cache a value, evicting the least recently used entry if the cache is full
+   */
+  ValueType& insert(const KeyType& key, ValueType&& value) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      m_entries.erase(it->second);
+      m_index.erase(it);
+    } else if (!m_entries.empty() && m_entries.size() >= m_capacity) {
+      m_index.erase(m_entries.back().first);
+      m_entries.pop_back();
+    }
+    m_entries.emplace_front(key, forward<ValueType>(value));
+    m_index.emplace(key, m_entries.begin());
+    return m_entries.front().second;
+  }
+
+  void clear() {
+    m_index.clear();
+    m_entries.clear();
+  }
+
+  size_t size() const {
+    return m_entries.size();
+  }
+
+  size_t capacity() const {
+    return m_capacity;
+  }
+
+  size_t hits() const {
+    return m_hits;
+  }
+
+  size_t misses() const {
+    return m_misses;
+  }
+
+ private:
+  size_t m_capacity;
+  size_t m_hits{0};
+  size_t m_misses{0};
+  list_type m_entries;
+  map_type m_index;
+};
+
 POLYBAR_NS_END
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 
 #include "common.hpp"
@@ -33,6 +35,9 @@ DEFINE_ERROR(command_error);
  *   cmd->wait();
  * @endcode
  *
+ * Commands that aren't waited for are collected by the reaper once
+ * they exit, which is what `is_running()` reports.
+ *
  * @code cpp
  *   auto cmd = command_util::make_command("for i in 1 2 3; do echo $i; done");
  *   cmd->exec();
@@ -47,7 +52,7 @@ class command {
   ~command();
 
   int exec(bool wait_for_completion = true);
-  void terminate();
+  void terminate(std::chrono::milliseconds grace = std::chrono::milliseconds{500});
   bool is_running();
   int wait();
 
@@ -58,9 +63,12 @@ class command {
   int get_stdout(int c);
   int get_stdin(int c);
   pid_t get_pid();
+  int get_pidfd();
   int get_exit_status();
 
  protected:
+  bool wait_for(std::chrono::milliseconds timeout);
+
   const logger& m_log;
 
   string m_cmd;
@@ -71,6 +79,10 @@ class command {
   pid_t m_forkpid{};
   int m_forkstatus{};
 
+  int m_pidfd{-1};
+  bool m_watched{false};
+  std::atomic_bool m_exited{false};
+
   std::mutex m_pipelock{};
 };
 
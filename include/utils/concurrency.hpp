@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <thread>
@@ -63,6 +64,82 @@ class mutex_wrapper : public T {
   mutable mutex m_mtx;
 };
 
+/**
+ * Single slot channel where each posted value replaces the pending one
+ *
+ * Posting never waits for the consumer and the consumer
+ * always receives the most recently posted value
+ */
+template <typename T>
+class mailbox : public non_copyable_mixin<mailbox<T>> {
+ public:
+  /**
+   * Store value for the consumer
+   *
+   * @return true if a pending value was discarded
+   */
+  bool post(T value) {
+    return post(move(value), [](T&, T&) {});
+  }
+
+  /**
+   * Store value for the consumer
+   *
+   * If a value is still pending, `merge(pending, value)` gets called
+   * before it is discarded so that the new value can inherit from it
+   *
+   * @return true if a pending value was discarded
+   */
+  template <typename Merge>
+  bool post(T value, Merge merge) {
+    bool replaced{false};
+    {
+      std::lock_guard<mutex> guard(m_mtx);
+      if ((replaced = m_pending)) {
+        merge(m_value, value);
+      }
+      m_value = move(value);
+      m_pending = true;
+    }
+    m_cond.notify_one();
+    return replaced;
+  }
+
+  /**
+   * Wait until a value has been posted and take it
+   *
+   * @return false if the mailbox was closed and no value is left
+   */
+  bool wait(T& value) {
+    std::unique_lock<mutex> guard(m_mtx);
+    m_cond.wait(guard, [&] { return m_pending || m_closed; });
+    if (!m_pending) {
+      return false;
+    }
+    value = move(m_value);
+    m_pending = false;
+    return true;
+  }
+
+  /**
+   * Wake up the consumer once the pending value has been taken
+   */
+  void close() {
+    {
+      std::lock_guard<mutex> guard(m_mtx);
+      m_closed = true;
+    }
+    m_cond.notify_all();
+  }
+
+ private:
+  mutex m_mtx;
+  std::condition_variable m_cond;
+  T m_value{};
+  bool m_pending{false};
+  bool m_closed{false};
+};
+
 namespace concurrency_util {
   size_t thread_id(const thread::id id);
 }
@@ -10,6 +10,8 @@ namespace process_util {
 
   void exec(char* cmd, char** args);
   void exec_sh(const char* cmd);
+  pid_t spawn_sh(const char* cmd, int fd_in, int fd_out, const vector<int>& close_fds);
+  int open_pidfd(pid_t pid);
 
   pid_t wait_for_completion(pid_t process_id, int* status_addr, int waitflags = 0);
   pid_t wait_for_completion(int* status_addr, int waitflags = 0);
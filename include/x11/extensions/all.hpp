@@ -20,3 +20,6 @@
 #if WITH_XKB
 #include "x11/extensions/xkb.hpp"
 #endif
+#if WITH_XSHM
+#include "x11/extensions/shm.hpp"
+#endif
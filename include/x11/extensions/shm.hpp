@@ -0,0 +1,50 @@
+#pragma once
+
+#include "settings.hpp"
+
+#if not WITH_XSHM
+#error "X Shm extension is disabled..."
+#endif
+
+#include <xcb/shm.h>
+
+#include "common.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+// fwd
+class connection;
+
+namespace shm_util {
+  void query_extension(connection& conn);
+}
+
+/**
+ * Shared memory segment attached to the X server
+ *
+ * Images stored in the segment can be pushed to a drawable
+ * without copying the pixel data through the socket
+ */
+class shm_segment : non_copyable_mixin<shm_segment> {
+ public:
+  explicit shm_segment(connection& conn, size_t size);
+  ~shm_segment();
+
+  unsigned char* data() const;
+
+  void put_image(xcb_drawable_t drawable, xcb_gcontext_t gc, uint16_t total_width, uint16_t total_height,
+      const xcb_rectangle_t& area, uint8_t depth);
+  void sync();
+
+ private:
+  connection& m_connection;
+  int m_shmid{-1};
+  unsigned char* m_data{nullptr};
+  xcb_shm_seg_t m_seg{XCB_NONE};
+
+  // Set while the server may still be reading from the segment
+  bool m_pending{false};
+};
+
+POLYBAR_NS_END
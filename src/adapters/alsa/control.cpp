@@ -92,6 +92,23 @@ namespace alsa {
     return false;
   }
 
+  /**
+   * Get the descriptors that become ready when the control has events
+   */
+  vector<struct pollfd> control::get_poll_descriptors() {
+    assert(m_ctl);
+
+    int count{snd_ctl_poll_descriptors_count(m_ctl)};
+    vector<struct pollfd> fds(std::max(0, count));
+
+    if (count < 0 || (count = snd_ctl_poll_descriptors(m_ctl, fds.data(), fds.size())) < 0) {
+      throw_exception<control_error>("Failed to get poll descriptors", count);
+    }
+
+    fds.resize(count);
+    return fds;
+  }
+
   /**
    * Check if the interface is in use
    */
@@ -80,6 +80,23 @@ namespace alsa {
     return process_events() > 0;
   }
 
+  /**
+   * Get the descriptors that become ready when the mixer has events
+   */
+  vector<struct pollfd> mixer::get_poll_descriptors() {
+    assert(m_mixer);
+
+    int count{snd_mixer_poll_descriptors_count(m_mixer)};
+    vector<struct pollfd> fds(std::max(0, count));
+
+    if (count < 0 || (count = snd_mixer_poll_descriptors(m_mixer, fds.data(), fds.size())) < 0) {
+      throw_exception<mixer_error>("Failed to get poll descriptors", count);
+    }
+
+    fds.resize(count);
+    return fds;
+  }
+
   /**
    * Process queued mixer events
    */
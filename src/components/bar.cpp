@@ -2,7 +2,6 @@
 
 #include "components/bar.hpp"
 #include "components/config.hpp"
-#include "components/parser.hpp"
 #include "components/renderer.hpp"
 #include "components/screen.hpp"
 #include "components/taskqueue.hpp"
@@ -32,28 +31,46 @@ using namespace signals::ui;
 /**
  * Create instance
  */
-bar::make_type bar::make(bool only_initialize_values) {
+bar::make_type bar::make(bool only_initialize_values, bool headless) {
   // clang-format off
   return factory_util::unique<bar>(
-        connection::make(),
+        headless ? nullptr : &connection::make(),
         signal_emitter::make(),
         config::make(),
         logger::make(),
-        screen::make(),
-        tray_manager::make(),
-        parser::make(),
+        headless ? nullptr : screen::make(),
+        headless ? nullptr : tray_manager::make(),
         taskqueue::make(),
         only_initialize_values);
   // clang-format on
 }
 
+/**
+ * Create instance for an additional bar section hosted by the same process
+ *
+ * Only the first bar manages the system tray
+ */
+bar::make_type bar::make(const config& conf, bool headless) {
+  // clang-format off
+  return factory_util::unique<bar>(
+        headless ? nullptr : &connection::make(),
+        signal_emitter::make(),
+        conf,
+        logger::make(),
+        headless ? nullptr : screen::make(),
+        nullptr,
+        taskqueue::make(),
+        false);
+  // clang-format on
+}
+
 /**
  * Construct bar instance
  *
  * TODO: Break out all tray handling
  */
-bar::bar(connection& conn, signal_emitter& emitter, const config& config, const logger& logger,
-    unique_ptr<screen>&& screen, unique_ptr<tray_manager>&& tray_manager, unique_ptr<parser>&& parser,
+bar::bar(connection* conn, signal_emitter& emitter, const config& config, const logger& logger,
+    unique_ptr<screen>&& screen, unique_ptr<tray_manager>&& tray_manager,
     unique_ptr<taskqueue>&& taskqueue, bool only_initialize_values)
     : m_connection(conn)
     , m_sig(emitter)
@@ -61,56 +78,16 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
     , m_log(logger)
     , m_screen(forward<decltype(screen)>(screen))
     , m_tray(forward<decltype(tray_manager)>(tray_manager))
-    , m_parser(forward<decltype(parser)>(parser))
     , m_taskqueue(forward<decltype(taskqueue)>(taskqueue)) {
   string bs{m_conf.section()};
 
-  // Get available RandR outputs
-  auto monitor_name = m_conf.get(bs, "monitor", ""s);
-  auto monitor_name_fallback = m_conf.get(bs, "monitor-fallback", ""s);
-  auto monitor_strictmode = m_conf.get(bs, "monitor-strict", false);
-  auto monitors = randr_util::get_monitors(m_connection, m_connection.screen()->root, monitor_strictmode);
-
-  if (monitors.empty()) {
-    throw application_error("No monitors found");
-  }
-
-  if (monitor_name.empty() && !monitor_strictmode) {
-    auto connected_monitors = randr_util::get_monitors(m_connection, m_connection.screen()->root, true);
-    if (!connected_monitors.empty()) {
-      monitor_name = connected_monitors[0]->name;
-      m_log.warn("No monitor specified, using \"%s\"", monitor_name);
-    }
-  }
-
-  if (monitor_name.empty()) {
-    monitor_name = monitors[0]->name;
-    m_log.warn("No monitor specified, using \"%s\"", monitor_name);
-  }
-
-  bool name_found{false};
-  bool fallback_found{monitor_name_fallback.empty()};
-  monitor_t fallback{};
-
-  for (auto&& monitor : monitors) {
-    if (!name_found && (name_found = monitor->match(monitor_name, monitor_strictmode))) {
-      m_opts.monitor = move(monitor);
-    } else if (!fallback_found && (fallback_found = monitor->match(monitor_name_fallback, monitor_strictmode))) {
-      fallback = move(monitor);
-    }
-
-    if (name_found && fallback_found) {
-      break;
-    }
-  }
-
-  if (!m_opts.monitor) {
-    if (fallback) {
-      m_opts.monitor = move(fallback);
-      m_log.warn("Monitor \"%s\" not found, reverting to fallback \"%s\"", monitor_name, monitor_name_fallback);
-    } else {
-      throw application_error("Monitor \"" + monitor_name + "\" not found or disconnected");
-    }
+  if (m_connection != nullptr) {
+    load_monitor(bs);
+  } else {
+    // Lay out the bar on a virtual monitor when rendering offscreen
+    auto w = m_conf.get("settings", "offscreen-width", 1920);
+    auto h = m_conf.get("settings", "offscreen-height", 1080);
+    m_opts.monitor = randr_util::make_monitor(XCB_NONE, "offscreen", w, h, 0, 0);
   }
 
   m_log.info("Loaded monitor %s (%ix%i+%i+%i)", m_opts.monitor->name, m_opts.monitor->w, m_opts.monitor->h,
@@ -274,8 +251,10 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
 
   m_log.info("Bar geometry: %ix%i+%i+%i", m_opts.size.w, m_opts.size.h, m_opts.pos.x, m_opts.pos.y);
 
-  m_log.trace("bar: Attach X event sink");
-  m_connection.attach_sink(this, SINK_PRIORITY_BAR);
+  if (m_connection != nullptr) {
+    m_log.trace("bar: Attach X event sink");
+    m_connection->attach_sink(this, SINK_PRIORITY_BAR);
+  }
 
   m_log.trace("bar: Attach signal receiver");
   m_sig.attach(this);
@@ -285,9 +264,72 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
  * Cleanup signal handlers and destroy the bar window
  */
 bar::~bar() {
-  std::lock_guard<std::mutex> guard(m_mutex);
-  m_connection.detach_sink(this, SINK_PRIORITY_BAR);
+  // Draw the last composed frame before stopping the render thread
+  m_frames.close();
+  if (m_render_thread.joinable()) {
+    m_render_thread.join();
+  }
+
+  // Detaching waits for running handlers, which may need the lock
   m_sig.detach(this);
+
+  std::lock_guard<std::mutex> guard(m_mutex);
+  if (m_connection != nullptr) {
+    m_connection->detach_sink(this, SINK_PRIORITY_BAR);
+  }
+}
+
+/**
+ * Find the monitor the bar should be placed on
+ */
+void bar::load_monitor(const string& bs) {
+  // Get available RandR outputs
+  auto monitor_name = m_conf.get(bs, "monitor", ""s);
+  auto monitor_name_fallback = m_conf.get(bs, "monitor-fallback", ""s);
+  auto monitor_strictmode = m_conf.get(bs, "monitor-strict", false);
+  auto monitors = randr_util::get_monitors(*m_connection, m_connection->screen()->root, monitor_strictmode);
+
+  if (monitors.empty()) {
+    throw application_error("No monitors found");
+  }
+
+  if (monitor_name.empty() && !monitor_strictmode) {
+    auto connected_monitors = randr_util::get_monitors(*m_connection, m_connection->screen()->root, true);
+    if (!connected_monitors.empty()) {
+      monitor_name = connected_monitors[0]->name;
+      m_log.warn("No monitor specified, using \"%s\"", monitor_name);
+    }
+  }
+
+  if (monitor_name.empty()) {
+    monitor_name = monitors[0]->name;
+    m_log.warn("No monitor specified, using \"%s\"", monitor_name);
+  }
+
+  bool name_found{false};
+  bool fallback_found{monitor_name_fallback.empty()};
+  monitor_t fallback{};
+
+  for (auto&& monitor : monitors) {
+    if (!name_found && (name_found = monitor->match(monitor_name, monitor_strictmode))) {
+      m_opts.monitor = move(monitor);
+    } else if (!fallback_found && (fallback_found = monitor->match(monitor_name_fallback, monitor_strictmode))) {
+      fallback = move(monitor);
+    }
+
+    if (name_found && fallback_found) {
+      break;
+    }
+  }
+
+  if (!m_opts.monitor) {
+    if (fallback) {
+      m_opts.monitor = move(fallback);
+      m_log.warn("Monitor \"%s\" not found, reverting to fallback \"%s\"", monitor_name, monitor_name_fallback);
+    } else {
+      throw application_error("Monitor \"" + monitor_name + "\" not found or disconnected");
+    }
+  }
 }
 
 /**
@@ -298,28 +340,58 @@ const bar_settings bar::settings() const {
 }
 
 /**
- * Parse input string and redraw the bar window
+ * Hand given display list over to the render thread
  *
- * @param data Input string
- * @param force Unless true, do not parse unchanged data
+ * A frame that is still waiting to be drawn gets replaced,
+ * so the render thread always draws the latest contents
+ *
+ * @param commands Parsed bar contents
+ * @param force Redraw even if the bar is shaded
  */
-void bar::parse(string&& data, bool force) {
-  if (!m_mutex.try_lock()) {
-    return;
+void bar::draw(const display_list& commands, bool force) {
+  // Don't lose the requests attached to a frame that never got drawn
+  const auto merge = [](frame& pending, frame& next) {
+    next.force = next.force || pending.force;
+    if (next.snapshot_dst.empty()) {
+      next.snapshot_dst = move(pending.snapshot_dst);
+    }
+  };
+
+  if (m_frames.post(frame{commands, force, move(m_snapshot_dst)}, merge)) {
+    m_log.trace_x("bar: Replaced pending frame");
+  }
+  m_snapshot_dst.clear();
+}
+
+/**
+ * Render thread loop drawing the most recently posted frame
+ */
+void bar::render_frames() {
+  frame next{};
+  while (m_frames.wait(next)) {
+    try {
+      if (!next.snapshot_dst.empty()) {
+        m_renderer->on(signals::ui::request_snapshot{move(next.snapshot_dst)});
+      }
+      render(next.commands, next.force);
+    } catch (const exception& err) {
+      m_log.err("Failed to draw bar contents (reason: %s)", err.what());
+    }
   }
+}
 
-  std::lock_guard<std::mutex> guard(m_mutex, std::adopt_lock);
+/**
+ * Draw given commands onto the bar window
+ */
+void bar::render(const display_list& commands, bool force) {
+  std::lock_guard<std::mutex> guard(m_mutex);
 
   if (force) {
     m_log.trace("bar: Force update");
   } else if (m_opts.shaded) {
     return m_log.trace("bar: Ignoring update (shaded)");
-  } else if (data == m_lastinput) {
-    return;
   }
 
-  m_lastinput = data;
-
   auto rect = m_opts.inner_area();
 
   if (m_tray && !m_tray->settings().detached && m_tray->settings().configured_slots) {
@@ -335,13 +407,7 @@ void bar::parse(string&& data, bool force) {
 
   m_log.info("Redrawing bar window");
   m_renderer->begin(rect);
-
-  try {
-    m_parser->parse(settings(), data);
-  } catch (const parser_error& err) {
-    m_log.err("Failed to parse contents (reason: %s)", err.what());
-  }
-
+  m_renderer->render(commands);
   m_renderer->end();
 
   const auto check_dblclicks = [&]() -> bool {
@@ -376,10 +442,10 @@ void bar::restack_window() {
   auto restacked = false;
 
   if (wm_restack == "bspwm") {
-    restacked = bspwm_util::restack_to_root(m_connection, m_opts.monitor, m_opts.window);
+    restacked = bspwm_util::restack_to_root(*m_connection, m_opts.monitor, m_opts.window);
 #if ENABLE_I3
   } else if (wm_restack == "i3" && m_opts.override_redirect) {
-    restacked = i3_util::restack_to_root(m_connection, m_opts.window);
+    restacked = i3_util::restack_to_root(*m_connection, m_opts.window);
   } else if (wm_restack == "i3" && !m_opts.override_redirect) {
     m_log.warn("Ignoring restack of i3 window (not needed when `override-redirect = false`)");
     wm_restack.clear();
@@ -400,7 +466,7 @@ void bar::restack_window() {
  * Reconfigure window position
  */
 void bar::reconfigure_pos() {
-  window win{m_connection, m_opts.window};
+  window win{*m_connection, m_opts.window};
   win.reconfigure_pos(m_opts.pos.x, m_opts.pos.y);
 }
 
@@ -408,7 +474,7 @@ void bar::reconfigure_pos() {
  * Reconfigure window strut values
  */
 void bar::reconfigure_struts() {
-  auto geom = m_connection.get_geometry(m_screen->root());
+  auto geom = m_connection->get_geometry(m_screen->root());
   auto w = m_opts.size.w + m_opts.offset.x;
   auto h = m_opts.size.h + m_opts.offset.y;
 
@@ -424,7 +490,7 @@ void bar::reconfigure_struts() {
     h += m_opts.monitor->y;
   }
 
-  window win{m_connection, m_opts.window};
+  window win{*m_connection, m_opts.window};
   win.reconfigure_struts(w, h, m_opts.pos.x, m_opts.origin == edge::BOTTOM);
 }
 
@@ -435,7 +501,7 @@ void bar::reconfigure_wm_hints() {
   const auto& win = m_opts.window;
 
   m_log.trace("bar: Set window WM_NAME");
-  icccm_util::set_wm_name(m_connection, win, m_opts.wmname.c_str(), m_opts.wmname.size(), "polybar\0Polybar", 15_z);
+  icccm_util::set_wm_name(*m_connection, win, m_opts.wmname.c_str(), m_opts.wmname.size(), "polybar\0Polybar", 15_z);
 
   m_log.trace("bar: Set window _NET_WM_WINDOW_TYPE");
   ewmh_util::set_wm_window_type(win, {_NET_WM_WINDOW_TYPE_DOCK});
@@ -454,7 +520,7 @@ void bar::reconfigure_wm_hints() {
  * Broadcast current map state
  */
 void bar::broadcast_visibility() {
-  auto attr = m_connection.get_window_attributes(m_opts.window);
+  auto attr = m_connection->get_window_attributes(m_opts.window);
 
   if (attr->map_state == XCB_MAP_STATE_UNVIEWABLE) {
     m_sig.emit(visibility_change{move(false)});
@@ -471,7 +537,7 @@ void bar::broadcast_visibility() {
 void bar::handle(const evt::client_message& evt) {
   if (evt->type == WM_PROTOCOLS && evt->data.data32[0] == WM_DELETE_WINDOW && evt->window == m_opts.window) {
     m_log.err("Bar window has been destroyed, shutting down...");
-    m_connection.disconnect();
+    m_connection->disconnect();
   }
 }
 
@@ -480,7 +546,7 @@ void bar::handle(const evt::client_message& evt) {
  */
 void bar::handle(const evt::destroy_notify& evt) {
   if (evt->window == m_opts.window) {
-    m_connection.disconnect();
+    m_connection->disconnect();
   }
 }
 
@@ -490,7 +556,11 @@ void bar::handle(const evt::destroy_notify& evt) {
  * Used to brighten the window by setting the
  * _NET_WM_WINDOW_OPACITY atom value
  */
-void bar::handle(const evt::enter_notify&) {
+void bar::handle(const evt::enter_notify& evt) {
+  if (evt->event != m_opts.window) {
+    return;
+  }
+
 #if 0
 #ifdef DEBUG_SHADED
   if (m_opts.origin == edge::TOP) {
@@ -516,7 +586,11 @@ void bar::handle(const evt::enter_notify&) {
  * Used to dim the window by setting the
  * _NET_WM_WINDOW_OPACITY atom value
  */
-void bar::handle(const evt::leave_notify&) {
+void bar::handle(const evt::leave_notify& evt) {
+  if (evt->event != m_opts.window) {
+    return;
+  }
+
 #if 0
 #ifdef DEBUG_SHADED
   if (m_opts.origin == edge::TOP) {
@@ -540,7 +614,9 @@ void bar::handle(const evt::leave_notify&) {
  * Used to map mouse clicks to bar actions
  */
 void bar::handle(const evt::button_press& evt) {
-  if (!m_mutex.try_lock()) {
+  if (evt->event != m_opts.window) {
+    return;
+  } else if (!m_mutex.try_lock()) {
     return;
   }
 
@@ -606,7 +682,7 @@ void bar::handle(const evt::button_press& evt) {
  */
 void bar::handle(const evt::expose& evt) {
   if (evt->window == m_opts.window && evt->count == 0) {
-    if (m_tray->settings().running) {
+    if (m_tray && m_tray->settings().running) {
       broadcast_visibility();
     }
 
@@ -629,7 +705,7 @@ void bar::handle(const evt::expose& evt) {
  */
 void bar::handle(const evt::property_notify& evt) {
 #ifdef DEBUG_LOGGER_VERBOSE
-  string atom_name = m_connection.get_atom_name(evt->atom).name();
+  string atom_name = m_connection->get_atom_name(evt->atom).name();
   m_log.trace_x("bar: property_notify(%s)", atom_name);
 #endif
 
@@ -640,16 +716,25 @@ void bar::handle(const evt::property_notify& evt) {
 
 bool bar::on(const signals::eventqueue::start&) {
   m_log.trace("bar: Create renderer");
-  m_renderer = renderer::make(m_opts);
+  m_renderer = renderer::make(m_opts, m_conf, m_connection == nullptr);
   m_opts.window = m_renderer->window();
 
+  if (m_connection == nullptr) {
+    m_log.trace("bar: Draw empty bar (offscreen)");
+    m_renderer->begin(m_opts.inner_area());
+    m_renderer->end();
+    m_render_thread = thread(&bar::render_frames, this);
+    m_sig.emit(signals::ui::ready{});
+    return false;
+  }
+
   // Subscribe to window enter and leave events
   // if we should dim the window
   if (m_opts.dimvalue != 1.0) {
-    m_connection.ensure_event_mask(m_opts.window, XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW);
+    m_connection->ensure_event_mask(m_opts.window, XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW);
   }
 
-  m_log.info("Bar window: %s", m_connection.id(m_opts.window));
+  m_log.info("Bar window: %s", m_connection->id(m_opts.window));
   restack_window();
 
   m_log.trace("bar: Reconfigure window");
@@ -657,7 +742,7 @@ bool bar::on(const signals::eventqueue::start&) {
   reconfigure_wm_hints();
 
   m_log.trace("bar: Map window");
-  m_connection.map_window_checked(m_opts.window);
+  m_connection->map_window_checked(m_opts.window);
 
   // Reconfigure window position after mapping (required by Openbox)
   // Required by Openbox
@@ -667,15 +752,21 @@ bool bar::on(const signals::eventqueue::start&) {
   m_renderer->begin(m_opts.inner_area());
   m_renderer->end();
 
+  m_log.trace("bar: Start render thread");
+  m_render_thread = thread(&bar::render_frames, this);
+
   m_sig.emit(signals::ui::ready{});
 
   // TODO: tray manager could run this internally on ready event
-  m_log.trace("bar: Setup tray manager");
-  m_tray->setup(static_cast<const bar_settings&>(m_opts));
+  if (m_tray) {
+    m_log.trace("bar: Setup tray manager");
+    m_tray->setup(static_cast<const bar_settings&>(m_opts));
+  }
 
   broadcast_visibility();
 
-  return true;
+  // Let the other hosted bars start as well
+  return false;
 }
 
 bool bar::on(const signals::ui::unshade_window&) {
@@ -685,7 +776,7 @@ bool bar::on(const signals::ui::unshade_window&) {
   m_opts.shade_pos.x = m_opts.pos.x;
   m_opts.shade_pos.y = m_opts.pos.y;
 
-  double distance{static_cast<double>(m_opts.shade_size.h - m_connection.get_geometry(m_opts.window)->height)};
+  double distance{static_cast<double>(m_opts.shade_size.h - m_connection->get_geometry(m_opts.window)->height)};
   double steptime{25.0 / 2.0};
   m_anim_step = distance / steptime / 2.0;
 
@@ -724,7 +815,7 @@ bool bar::on(const signals::ui::shade_window&) {
     m_opts.shade_pos.y = m_opts.pos.y + m_opts.size.h - m_opts.shade_size.h;
   }
 
-  double distance{static_cast<double>(m_connection.get_geometry(m_opts.window)->height - m_opts.shade_size.h)};
+  double distance{static_cast<double>(m_connection->get_geometry(m_opts.window)->height - m_opts.shade_size.h)};
   double steptime{25.0 / 2.0};
   m_anim_step = distance / steptime / 2.0;
 
@@ -747,7 +838,7 @@ bool bar::on(const signals::ui::shade_window&) {
 }
 
 bool bar::on(const signals::ui::tick&) {
-  auto geom = m_connection.get_geometry(m_opts.window);
+  auto geom = m_connection->get_geometry(m_opts.window);
   if (geom->y == m_opts.shade_pos.y && geom->height == m_opts.shade_size.h) {
     return false;
   }
@@ -774,8 +865,8 @@ bool bar::on(const signals::ui::tick&) {
 
   connection::pack_values(mask, &params, values);
 
-  m_connection.configure_window(m_opts.window, mask, values);
-  m_connection.flush();
+  m_connection->configure_window(m_opts.window, mask, values);
+  m_connection->flush();
 
   return false;
 }
@@ -786,4 +877,15 @@ bool bar::on(const signals::ui::dim_window& sig) {
   return false;
 }
 
+/**
+ * Hold on to the snapshot request until the next frame is posted
+ *
+ * Forwarding it to the renderer directly could capture
+ * a frame that was composed before the request
+ */
+bool bar::on(const signals::ui::request_snapshot& evt) {
+  m_snapshot_dst = evt.cast();
+  return true;
+}
+
 POLYBAR_NS_END
@@ -1,6 +1,8 @@
 #include <utility>
 
 #include "components/builder.hpp"
+#include "components/logger.hpp"
+#include "components/parser.hpp"
 #include "drawtypes/label.hpp"
 #include "utils/color.hpp"
 #include "utils/math.hpp"
@@ -12,7 +14,7 @@ POLYBAR_NS
 #define BUILDER_SPACE_TOKEN "%__"
 #endif
 
-builder::builder(const bar_settings& bar) : m_bar(bar) {
+builder::builder(const bar_settings& bar) : m_bar(bar), m_parser(parser::make()) {
   m_tags[syntaxtag::A] = 0;
   m_tags[syntaxtag::B] = 0;
   m_tags[syntaxtag::F] = 0;
@@ -26,12 +28,86 @@ builder::builder(const bar_settings& bar) : m_bar(bar) {
   m_colors[syntaxtag::u] = string();
 }
 
+builder::~builder() {}
+
+/**
+ * Serialize draw commands to markup
+ *
+ * Used for the output written to stdout and for recorded frames.
+ * Parsing the result yields the same commands.
+ */
+string builder::markup(const bar_settings& bar, const display_list& commands) {
+  const auto color = [](unsigned int value, unsigned int fallback) {
+    return value == fallback ? string{"-"} : color_util::hex<unsigned short int>(value);
+  };
+  const auto attr = [](int value) {
+    return static_cast<attribute>(value) == attribute::UNDERLINE ? "u}" : "o}";
+  };
+
+  string output;
+
+  for (const auto& cmd : commands) {
+    switch (cmd.type) {
+      case drawtype::NONE:
+        break;
+      case drawtype::ALIGNMENT:
+        if (static_cast<alignment>(cmd.value) == alignment::LEFT) {
+          output += "%{l}";
+        } else if (static_cast<alignment>(cmd.value) == alignment::CENTER) {
+          output += "%{c}";
+        } else if (static_cast<alignment>(cmd.value) == alignment::RIGHT) {
+          output += "%{r}";
+        }
+        break;
+      case drawtype::BACKGROUND:
+        output += "%{B" + color(cmd.color, 0) + "}";
+        break;
+      case drawtype::FOREGROUND:
+        output += "%{F" + color(cmd.color, bar.foreground) + "}";
+        break;
+      case drawtype::UNDERLINE:
+        output += "%{u" + color(cmd.color, bar.underline.color) + "}";
+        break;
+      case drawtype::OVERLINE:
+        output += "%{o" + color(cmd.color, bar.overline.color) + "}";
+        break;
+      case drawtype::FONT:
+        output += "%{T" + (cmd.value ? to_string(cmd.value) : "-") + "}";
+        break;
+      case drawtype::OFFSET:
+        output += "%{O" + to_string(cmd.value) + "}";
+        break;
+      case drawtype::ATTRIBUTE_SET:
+        output += "%{+"s + attr(cmd.value);
+        break;
+      case drawtype::ATTRIBUTE_UNSET:
+        output += "%{-"s + attr(cmd.value);
+        break;
+      case drawtype::ATTRIBUTE_TOGGLE:
+        output += "%{!"s + attr(cmd.value);
+        break;
+      case drawtype::ACTION_BEGIN:
+        output += "%{A" + to_string(cmd.value) + ":" + cmd.data + ":}";
+        break;
+      case drawtype::ACTION_END:
+        output += "%{A}";
+        break;
+      case drawtype::TEXT:
+        output += cmd.data;
+        break;
+    }
+  }
+
+  // Join consecutive tags
+  return string_util::replace_all(output, "}%{", " ");
+}
+
 /**
  * Flush contents of the builder and return built string
  *
  * This will also close any unclosed tags
  */
-string builder::flush() {
+display_list builder::flush() {
   if (m_tags[syntaxtag::B]) {
     background_close();
   }
@@ -58,41 +134,32 @@ string builder::flush() {
     cmd_close();
   }
 
-  string output{m_output};
+  display_list output;
+  output.swap(m_output);
 
   // reset values
   m_tags.clear();
   m_colors.clear();
-  m_output.clear();
   m_fontindex = 1;
 
-  return string_util::replace_all(output, BUILDER_SPACE_TOKEN, " ");
-}
+  for (auto&& cmd : output) {
+    if (cmd.type == drawtype::TEXT || cmd.type == drawtype::ACTION_BEGIN) {
+      cmd.data = string_util::replace_all(cmd.data, BUILDER_SPACE_TOKEN, " ");
+    }
+  }
 
-/**
- * Insert raw text string
- */
-void builder::append(string text) {
-  m_output.reserve(text.size());
-  m_output += move(text);
+  return output;
 }
 
 /**
- * Insert text node
+ * Insert raw markup
  *
- * This will also parse raw syntax tags
+ * Tags are converted into the same draw commands the
+ * corresponding builder calls would have inserted
  */
-void builder::node(string str, bool add_space) {
-  if (str.empty()) {
-    return;
-  }
-
+void builder::append(string text) {
   string::size_type n, m;
-  string s(move(str));
-
-  if ((n = s.size()) > 2 && s[0] == '"' && s[n - 1] == '"') {
-    s = s.substr(1, n - 2);
-  }
+  string s(move(text));
 
   while (true) {
     if (s.empty()) {
@@ -166,12 +233,16 @@ void builder::node(string str, bool add_space) {
       overline_close();
       s.erase(0, 5);
 
+    } else if ((n = s.find("%{A")) == 0 && (m = s.find('}')) != string::npos) {
+      action(s.substr(n + 3, m - 3));
+      s.erase(n, m + 1);
+
     } else if ((n = s.find("%{")) == 0 && (m = s.find('}')) != string::npos) {
-      append(s.substr(n, m + 1));
+      tags(s.substr(n, m + 1));
       s.erase(n, m + 1);
 
     } else if ((n = s.find("%{")) > 0) {
-      append(s.substr(0, n));
+      push(drawcmd{drawtype::TEXT, 0U, 0, s.substr(0, n)});
       s.erase(0, n);
 
     } else {
@@ -180,8 +251,39 @@ void builder::node(string str, bool add_space) {
   }
 
   if (!s.empty()) {
-    append(s);
+    push(drawcmd{drawtype::TEXT, 0U, 0, move(s)});
   }
+}
+
+/**
+ * Insert draw commands built by another builder
+ */
+void builder::append(display_list commands) {
+  m_output.reserve(m_output.size() + commands.size());
+  for (auto&& cmd : commands) {
+    push(move(cmd));
+  }
+}
+
+/**
+ * Insert text node
+ *
+ * This will also parse raw syntax tags
+ */
+void builder::node(string str, bool add_space) {
+  if (str.empty()) {
+    return;
+  }
+
+  string::size_type n;
+  string s(move(str));
+
+  if ((n = s.size()) > 2 && s[0] == '"' && s[n - 1] == '"') {
+    s = s.substr(1, n - 2);
+  }
+
+  append(move(s));
+
   if (add_space) {
     space();
   }
@@ -298,7 +400,7 @@ void builder::offset(int pixels) {
   if (pixels == 0) {
     return;
   }
-  tag_open(syntaxtag::O, to_string(pixels));
+  push(drawcmd{drawtype::OFFSET, 0U, pixels});
 }
 
 /**
@@ -306,23 +408,33 @@ void builder::offset(int pixels) {
  */
 void builder::space(size_t width) {
   if (width) {
-    m_output.append(width, ' ');
+    push(drawcmd{drawtype::TEXT, 0U, 0, string(width, ' ')});
   } else {
     space();
   }
 }
 void builder::space() {
-  m_output.append(m_bar.spacing, ' ');
+  push(drawcmd{drawtype::TEXT, 0U, 0, string(m_bar.spacing, ' ')});
 }
 
 /**
  * Remove trailing space
  */
 void builder::remove_trailing_space(size_t len) {
-  if (len == 0_z || len > m_output.size()) {
+  if (len == 0_z || m_output.empty() || m_output.back().type != drawtype::TEXT) {
+    return;
+  }
+
+  string& text{m_output.back().data};
+
+  if (len > text.size()) {
     return;
-  } else if (m_output.substr(m_output.size() - len) == string(len, ' ')) {
-    m_output.erase(m_output.size() - len);
+  } else if (text.compare(text.size() - len, len, string(len, ' ')) == 0) {
+    text.erase(text.size() - len);
+  }
+
+  if (text.empty()) {
+    m_output.pop_back();
   }
 }
 void builder::remove_trailing_space() {
@@ -337,7 +449,7 @@ void builder::font(int index) {
     return;
   }
   m_fontindex = index;
-  tag_open(syntaxtag::T, to_string(index));
+  tag_open(syntaxtag::T, drawcmd{drawtype::FONT, 0U, index});
 }
 
 /**
@@ -360,9 +472,8 @@ void builder::background(string color) {
     color = color.substr(0, 4);
   }
 
-  color = color_util::simplify_hex(color);
   m_colors[syntaxtag::B] = color;
-  tag_open(syntaxtag::B, color);
+  tag_open(syntaxtag::B, drawcmd{drawtype::BACKGROUND, color_util::parse(color, 0)});
 }
 
 /**
@@ -387,9 +498,8 @@ void builder::color(string color) {
     color = color.substr(0, 4);
   }
 
-  color = color_util::simplify_hex(color);
   m_colors[syntaxtag::F] = color;
-  tag_open(syntaxtag::F, color);
+  tag_open(syntaxtag::F, drawcmd{drawtype::FOREGROUND, color_util::parse(color, m_bar.foreground)});
 }
 
 /**
@@ -438,9 +548,8 @@ void builder::line_color_close() {
  * Insert tag to alter the current overline color
  */
 void builder::overline_color(string color) {
-  color = color_util::simplify_hex(color);
   m_colors[syntaxtag::o] = color;
-  tag_open(syntaxtag::o, color);
+  tag_open(syntaxtag::o, drawcmd{drawtype::OVERLINE, color_util::parse(color, m_bar.overline.color)});
   tag_open(attribute::OVERLINE);
 }
 
@@ -456,9 +565,8 @@ void builder::overline_color_close() {
  * Insert tag to alter the current underline color
  */
 void builder::underline_color(string color) {
-  color = color_util::simplify_hex(color);
   m_colors[syntaxtag::u] = color;
-  tag_open(syntaxtag::u, color);
+  tag_open(syntaxtag::u, drawcmd{drawtype::UNDERLINE, color_util::parse(color, m_bar.underline.color)});
   tag_open(attribute::UNDERLINE);
 }
 
@@ -512,7 +620,7 @@ void builder::underline_close() {
 void builder::cmd(mousebtn index, string action, bool condition) {
   if (condition && !action.empty()) {
     action = string_util::replace_all(action, ":", "\\:");
-    tag_open(syntaxtag::A, to_string(static_cast<int>(index)) + ":" + action + ":");
+    tag_open(syntaxtag::A, drawcmd{drawtype::ACTION_BEGIN, 0U, static_cast<int>(index), move(action)});
   }
 }
 
@@ -522,7 +630,7 @@ void builder::cmd(mousebtn index, string action, bool condition) {
 void builder::cmd(mousebtn index, string action, const label_t& label) {
   if (!action.empty() && label && *label) {
     action = string_util::replace_all(action, ":", "\\:");
-    tag_open(syntaxtag::A, to_string(static_cast<int>(index)) + ":" + action + ":");
+    tag_open(syntaxtag::A, drawcmd{drawtype::ACTION_BEGIN, 0U, static_cast<int>(index), move(action)});
     node(label);
     tag_close(syntaxtag::A);
   }
@@ -557,44 +665,89 @@ string builder::foreground_hex() {
   return m_foreground;
 }
 
+/**
+ * Insert draw command
+ *
+ * Adjacent text runs are merged and a state change directly
+ * followed by another one of the same kind is dropped
+ */
+void builder::push(drawcmd cmd) {
+  if (cmd.type == drawtype::TEXT && cmd.data.empty()) {
+    return;
+  } else if (m_output.empty() || m_output.back().type != cmd.type) {
+    m_output.emplace_back(move(cmd));
+    return;
+  }
+
+  switch (cmd.type) {
+    case drawtype::TEXT:
+      m_output.back().data += cmd.data;
+      break;
+    case drawtype::BACKGROUND:
+    case drawtype::FOREGROUND:
+    case drawtype::UNDERLINE:
+    case drawtype::OVERLINE:
+    case drawtype::FONT:
+      m_output.back() = move(cmd);
+      break;
+    default:
+      m_output.emplace_back(move(cmd));
+      break;
+  }
+}
+
+/**
+ * Insert action block given as raw markup, i.e: A1:command: or A
+ */
+void builder::action(const string& tag) {
+  if (tag.empty() || (!isdigit(tag[0]) && tag[0] != ':')) {
+    tag_close(syntaxtag::A);
+    return;
+  }
+
+  int btn{tag[0] == ':' ? static_cast<int>(mousebtn::LEFT) : tag[0] - '0'};
+  size_t pos{tag[0] == ':' ? 0_z : 1_z};
+  string cmd;
+
+  if (pos < tag.size() && tag[pos] == ':') {
+    size_t end{pos + 1};
+    while ((end = tag.find(':', end)) != string::npos && tag[end - 1] == '\\') {
+      end++;
+    }
+    if (end != string::npos) {
+      cmd = tag.substr(pos + 1, end - pos - 1);
+    }
+  }
+
+  tag_open(syntaxtag::A, drawcmd{drawtype::ACTION_BEGIN, 0U, btn, move(cmd)});
+}
+
+/**
+ * Insert tag block given as raw markup that has no builder equivalent
+ */
+void builder::tags(const string& block) {
+  try {
+    m_parser->parse(m_bar, block, m_output);
+  } catch (const parser_error& err) {
+    logger::make().err("Ignoring markup \"%s\" (reason: %s)", block, err.what());
+  }
+}
+
 /**
  * Insert directive to change value of given tag
  */
-void builder::tag_open(syntaxtag tag, const string& value) {
+void builder::tag_open(syntaxtag tag, drawcmd cmd) {
   if (m_tags.find(tag) == m_tags.end()) {
     m_tags[tag] = 0;
   }
 
   m_tags[tag]++;
 
-  switch (tag) {
-    case syntaxtag::NONE:
-      break;
-    case syntaxtag::A:
-      append("%{A" + value + "}");
-      break;
-    case syntaxtag::F:
-      append("%{F" + value + "}");
-      break;
-    case syntaxtag::B:
-      append("%{B" + value + "}");
-      break;
-    case syntaxtag::T:
-      append("%{T" + value + "}");
-      break;
-    case syntaxtag::u:
-      append("%{u" + value + "}");
-      break;
-    case syntaxtag::o:
-      append("%{o" + value + "}");
-      break;
-    case syntaxtag::R:
-      append("%{R}");
-      break;
-    case syntaxtag::O:
-      append("%{O" + value + "}");
-      break;
+  if (tag == syntaxtag::A) {
+    m_actions.push_back(cmd.value);
   }
+
+  push(move(cmd));
 }
 
 /**
@@ -611,10 +764,10 @@ void builder::tag_open(attribute attr) {
     case attribute::NONE:
       break;
     case attribute::UNDERLINE:
-      append("%{+u}");
+      push(drawcmd{drawtype::ATTRIBUTE_SET, 0U, static_cast<int>(attr)});
       break;
     case attribute::OVERLINE:
-      append("%{+o}");
+      push(drawcmd{drawtype::ATTRIBUTE_SET, 0U, static_cast<int>(attr)});
       break;
   }
 }
@@ -633,22 +786,23 @@ void builder::tag_close(syntaxtag tag) {
     case syntaxtag::NONE:
       break;
     case syntaxtag::A:
-      append("%{A}");
+      push(drawcmd{drawtype::ACTION_END, 0U, m_actions.back()});
+      m_actions.pop_back();
       break;
     case syntaxtag::F:
-      append("%{F-}");
+      push(drawcmd{drawtype::FOREGROUND, m_bar.foreground});
       break;
     case syntaxtag::B:
-      append("%{B-}");
+      push(drawcmd{drawtype::BACKGROUND, 0U});
       break;
     case syntaxtag::T:
-      append("%{T-}");
+      push(drawcmd{drawtype::FONT, 0U, 0});
       break;
     case syntaxtag::u:
-      append("%{u-}");
+      push(drawcmd{drawtype::UNDERLINE, m_bar.underline.color});
       break;
     case syntaxtag::o:
-      append("%{o-}");
+      push(drawcmd{drawtype::OVERLINE, m_bar.overline.color});
       break;
     case syntaxtag::R:
       break;
@@ -671,10 +825,10 @@ void builder::tag_close(attribute attr) {
     case attribute::NONE:
       break;
     case attribute::UNDERLINE:
-      append("%{-u}");
+      push(drawcmd{drawtype::ATTRIBUTE_UNSET, 0U, static_cast<int>(attr)});
       break;
     case attribute::OVERLINE:
-      append("%{-o}");
+      push(drawcmd{drawtype::ATTRIBUTE_UNSET, 0U, static_cast<int>(attr)});
       break;
   }
 }
@@ -1,17 +1,21 @@
+#include <algorithm>
 #include <csignal>
 
 #include "components/bar.hpp"
+#include "components/builder.hpp"
 #include "components/config.hpp"
 #include "components/controller.hpp"
+#include "components/eventloop.hpp"
 #include "components/ipc.hpp"
 #include "components/logger.hpp"
 #include "components/renderer.hpp"
+#include "components/scheduler.hpp"
+#include "components/spawner.hpp"
 #include "components/types.hpp"
 #include "events/signal.hpp"
 #include "events/signal_emitter.hpp"
 #include "modules/meta/event_handler.hpp"
 #include "modules/meta/factory.hpp"
-#include "utils/command.hpp"
 #include "utils/factory.hpp"
 #include "utils/inotify.hpp"
 #include "utils/string.hpp"
@@ -23,15 +27,16 @@
 
 POLYBAR_NS
 
-array<int, 2> g_eventpipe{{-1, -1}};
+int g_eventfd{-1};
 sig_atomic_t g_reload{0};
 sig_atomic_t g_terminate{0};
 
 void interrupt_handler(int signum) {
   g_terminate = 1;
   g_reload = (signum == SIGUSR1);
-  if (write(g_eventpipe[PIPE_WRITE], &g_terminate, 1) == -1) {
-    throw system_error("Failed to write to eventpipe");
+  uint64_t value{1};
+  if (write(g_eventfd, &value, sizeof(value)) == -1) {
+    throw system_error("Failed to write to event channel");
   }
 }
 
@@ -42,32 +47,67 @@ void handler(int signum) {
 /**
  * Build controller instance
  */
-controller::make_type controller::make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch) {
-  return factory_util::unique<controller>(connection::make(), signal_emitter::make(), logger::make(), config::make(),
-      bar::make(), forward<decltype(ipc)>(ipc), forward<decltype(config_watch)>(config_watch));
+controller::make_type controller::make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch,
+    bool headless, const vector<string>& extra_bars) {
+  const config& conf{config::make()};
+  vector<unique_ptr<config>> confs;
+  vector<unique_ptr<bar>> bars;
+
+  bars.emplace_back(bar::make(false, headless));
+
+  // The additional bars read their own section from the same file
+  for (const auto& name : extra_bars) {
+    confs.emplace_back(factory_util::unique<config>(logger::make(), conf.filepath(), string{name}));
+    bars.emplace_back(bar::make(*confs.back(), headless));
+  }
+
+  return factory_util::unique<controller>(headless ? nullptr : &connection::make(), signal_emitter::make(),
+      logger::make(), conf, eventloop::make(), move(confs), move(bars), forward<decltype(ipc)>(ipc), forward<decltype(config_watch)>(config_watch));
 }
 
 /**
  * Construct controller
  */
-controller::controller(connection& conn, signal_emitter& emitter, const logger& logger, const config& config,
-    unique_ptr<bar>&& bar, unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& confwatch)
+controller::controller(connection* conn, signal_emitter& emitter, const logger& logger, const config& conf,
+    eventloop& loop, vector<unique_ptr<config>>&& confs, vector<unique_ptr<bar>>&& bars,
+    unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& confwatch)
     : m_connection(conn)
     , m_sig(emitter)
     , m_log(logger)
-    , m_conf(config)
-    , m_bar(forward<decltype(bar)>(bar))
+    , m_conf(conf)
+    , m_loop(loop)
+    , m_confs(forward<decltype(confs)>(confs))
     , m_ipc(forward<decltype(ipc)>(ipc))
     , m_confwatch(forward<decltype(confwatch)>(confwatch)) {
   m_swallow_input = m_conf.get("settings", "throttle-input-for", m_swallow_input);
-  m_swallow_limit = m_conf.deprecated("settings", "eventqueue-swallow", "throttle-output", m_swallow_limit);
-  m_swallow_update = m_conf.deprecated("settings", "eventqueue-swallow-time", "throttle-output-for", m_swallow_update);
 
-  if (pipe(g_eventpipe.data()) == 0) {
-    m_queuefd[PIPE_READ] = make_unique<file_descriptor>(g_eventpipe[PIPE_READ]);
-    m_queuefd[PIPE_WRITE] = make_unique<file_descriptor>(g_eventpipe[PIPE_WRITE]);
-  } else {
-    throw system_error("Failed to create event channel pipes");
+  // The frame scheduler replaces the old output throttling
+  m_conf.warn_deprecated("settings", "eventqueue-swallow", "frame-rate");
+  m_conf.warn_deprecated("settings", "throttle-output", "frame-rate");
+  m_conf.warn_deprecated("settings", "eventqueue-swallow-time", "frame-deadline");
+  m_conf.warn_deprecated("settings", "throttle-output-for", "frame-deadline");
+
+  auto frame_rate = m_conf.get("settings", "frame-rate", 30U);
+  m_frame_interval = chrono::milliseconds{frame_rate ? 1000U / frame_rate : 0U};
+  m_frame_deadline = m_conf.get("settings", "frame-deadline", m_frame_deadline);
+
+  m_serialize_actions = m_conf.get("settings", "serialize-actions", m_serialize_actions);
+  m_spawner = spawner::make(m_conf.get("settings", "action-limit", size_t{4}));
+  scheduler::make(m_conf.get("settings", "module-workers", size_t{2}));
+
+  g_eventfd = m_loop.get_wakeup_fd();
+
+  for (size_t i = 0; i < bars.size(); i++) {
+    m_bars.emplace_back();
+    m_bars.back().instance = move(bars[i]);
+    m_bars.back().conf = i == 0 ? &m_conf : m_confs[i - 1].get();
+  }
+
+  for (auto&& hosted : m_bars) {
+    const bar_settings bar{hosted.instance->settings()};
+    builder separator{bar};
+    separator.append(bar.separator);
+    hosted.separator = separator.flush();
   }
 
   m_log.trace("controller: Install signal handler");
@@ -83,34 +123,60 @@ controller::controller(connection& conn, signal_emitter& emitter, const logger&
   m_log.trace("controller: Setup user-defined modules");
   size_t created_modules{0};
 
-  for (int i = 0; i < 3; i++) {
-    alignment align{static_cast<alignment>(i + 1)};
-    string configured_modules;
+  // Modules that would produce the same output on several bars are only created once
+  std::map<string, modules::module_interface*> instances;
 
-    if (align == alignment::LEFT) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-left", ""s);
-    } else if (align == alignment::CENTER) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-center", ""s);
-    } else if (align == alignment::RIGHT) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-right", ""s);
-    }
+  for (auto&& hosted : m_bars) {
+    const bar_settings bar{hosted.instance->settings()};
+    const auto& bar_conf = *hosted.conf;
 
-    for (auto& module_name : string_util::split(configured_modules, ' ')) {
-      if (module_name.empty()) {
-        continue;
-      }
+    for (int i = 0; i < 3; i++) {
+      alignment align{static_cast<alignment>(i + 1)};
+      string configured_modules;
 
-      try {
-        auto type = m_conf.get("module/" + module_name, "type");
+      if (align == alignment::LEFT) {
+        configured_modules = bar_conf.get(bar_conf.section(), "modules-left", ""s);
+      } else if (align == alignment::CENTER) {
+        configured_modules = bar_conf.get(bar_conf.section(), "modules-center", ""s);
+      } else if (align == alignment::RIGHT) {
+        configured_modules = bar_conf.get(bar_conf.section(), "modules-right", ""s);
+      }
 
-        if (type == "custom/ipc" && !m_ipc) {
-          throw application_error("Inter-process messaging needs to be enabled");
+      for (auto& module_name : string_util::split(configured_modules, ' ')) {
+        if (module_name.empty()) {
+          continue;
         }
 
-        m_modules[align].emplace_back(make_module(move(type), m_bar->settings(), module_name));
-        created_modules++;
-      } catch (const runtime_error& err) {
-        m_log.err("Disabling module \"%s\" (reason: %s)", module_name, err.what());
+        try {
+          auto type = m_conf.get("module/" + module_name, "type");
+
+          // The modules and their builder only depend on these bar settings
+          // when formatting their output, i.e. locale, default colors and spacing
+          string key{module_name + ":" + bar.locale + ":" + to_string(bar.foreground) + ":" +
+                     to_string(bar.background) + ":" + to_string(bar.spacing)};
+          if (module_binds_monitor(type)) {
+            key += ":" + bar.monitor->name;
+          }
+
+          auto it = instances.find(key);
+
+          if (it == instances.end()) {
+            if (type == "custom/ipc" && !m_ipc) {
+              throw application_error("Inter-process messaging needs to be enabled");
+            } else if (m_connection == nullptr && module_requires_x(type)) {
+              throw application_error("Module requires an X server");
+            }
+
+            m_modules.emplace_back(make_module(move(type), bar, module_name));
+            it = instances.emplace_hint(it, key, m_modules.back().get());
+            created_modules++;
+          }
+
+          hosted.modules[align].emplace_back(it->second);
+          hosted.segments[align].emplace_back();
+        } catch (const runtime_error& err) {
+          m_log.err("Disabling module \"%s\" (reason: %s)", module_name, err.what());
+        }
       }
     }
   }
@@ -118,6 +184,10 @@ controller::controller(connection& conn, signal_emitter& emitter, const logger&
   if (!created_modules) {
     throw application_error("No modules created");
   }
+
+  if (m_bars.size() > 1) {
+    m_log.info("Hosting %lu bars with %lu shared modules", m_bars.size(), m_modules.size());
+  }
 }
 
 /**
@@ -133,15 +203,13 @@ controller::~controller() {
   m_sig.detach(this);
 
   m_log.trace("controller: Stop modules");
-  for (auto&& block : m_modules) {
-    for (auto&& module : block.second) {
-      auto module_name = module->name();
-      auto cleanup_ms = time_util::measure([&module] {
-        module->stop();
-        module.reset();
-      });
-      m_log.info("Deconstruction of %s took %lu ms.", module_name, cleanup_ms);
-    }
+  for (auto&& module : m_modules) {
+    auto module_name = module->name();
+    auto cleanup_ms = time_util::measure([&module] {
+      module->stop();
+      module.reset();
+    });
+    m_log.info("Deconstruction of %s took %lu ms.", module_name, cleanup_ms);
   }
 
   m_log.trace("controller: Joining threads");
@@ -155,38 +223,48 @@ controller::~controller() {
 /**
  * Run the main loop
  */
-bool controller::run(bool writeback, string snapshot_dst) {
+bool controller::run(bool writeback, string snapshot_dst, string record_dst) {
   m_log.info("Starting application");
   m_log.trace("controller: Main thread id = %i", concurrency_util::thread_id(this_thread::get_id()));
 
-  assert(!m_connection.connection_has_error());
+  assert(m_connection == nullptr || !m_connection->connection_has_error());
 
   m_writeback = writeback;
   m_snapshot_dst = move(snapshot_dst);
 
+  if (!record_dst.empty()) {
+    m_record = make_unique<std::ofstream>(record_dst, std::ios::trunc);
+    if (!m_record->is_open()) {
+      throw application_error("Failed to open " + record_dst + " for recording");
+    }
+    m_log.info("Recording frames to %s", record_dst);
+  }
+
   m_sig.attach(this);
 
   size_t started_modules{0};
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      auto inp_handler = dynamic_cast<input_handler*>(&*module);
-      auto evt_handler = dynamic_cast<event_handler_interface*>(&*module);
+  for (const auto& module : m_modules) {
+    auto inp_handler = dynamic_cast<input_handler*>(&*module);
+    auto evt_handler = dynamic_cast<event_handler_interface*>(&*module);
 
-      if (inp_handler != nullptr) {
-        m_inputhandlers.emplace_back(inp_handler);
-      }
+    if (inp_handler != nullptr) {
+      m_inputhandlers.emplace_back(inp_handler);
+    }
 
-      if (evt_handler != nullptr) {
-        evt_handler->connect(m_connection);
-      }
+    if (evt_handler != nullptr) {
+      evt_handler->connect(*m_connection);
+    }
+
+    try {
+      m_log.info("Starting %s", module->name());
+      module->start();
+      started_modules++;
 
-      try {
-        m_log.info("Starting %s", module->name());
-        module->start();
-        started_modules++;
-      } catch (const application_error& err) {
-        m_log.err("Failed to start '%s' (reason: %s)", module->name(), err.what());
+      if (!m_snapshot_dst.empty()) {
+        m_snapshot_pending.emplace(module->name());
       }
+    } catch (const application_error& err) {
+      m_log.err("Failed to start '%s' (reason: %s)", module->name(), err.what());
     }
   }
 
@@ -194,7 +272,10 @@ bool controller::run(bool writeback, string snapshot_dst) {
     throw application_error("No modules started");
   }
 
-  m_connection.flush();
+  if (m_connection != nullptr) {
+    m_connection->flush();
+  }
+
   m_event_thread = thread(&controller::process_eventqueue, this);
 
   read_events();
@@ -204,6 +285,12 @@ bool controller::run(bool writeback, string snapshot_dst) {
     m_event_thread.join();
   }
 
+  // The loop isn't dispatching anymore, so the timer can be closed safely
+  if (m_snapshot_timer != -1) {
+    m_loop.remove_timer(m_snapshot_timer);
+    m_snapshot_timer = -1;
+  }
+
   m_log.warn("Termination signal received, shutting down...");
 
   return !g_reload;
@@ -247,93 +334,92 @@ bool controller::enqueue(string&& input_data) {
 void controller::read_events() {
   m_log.info("Entering event loop (thread-id=%lu)", this_thread::get_id());
 
-  int fd_connection{-1};
-  int fd_confwatch{-1};
-  int fd_ipc{-1};
-
-  vector<int> fds;
-  fds.emplace_back(*m_queuefd[PIPE_READ]);
-  fds.emplace_back((fd_connection = m_connection.get_file_descriptor()));
+  // Process events on the xcb connection fd
+  if (m_connection != nullptr) {
+    m_loop.add(m_connection->get_file_descriptor(), EPOLLIN, [&](int, unsigned int) {
+      shared_ptr<xcb_generic_event_t> evt{};
+      while ((evt = shared_ptr<xcb_generic_event_t>(xcb_poll_for_event(*m_connection), free)) != nullptr) {
+        try {
+          m_connection->dispatch_event(evt);
+        } catch (xpp::connection_error& err) {
+          m_log.err("X connection error, terminating... (what: %s)", m_connection->error_str(err.code()));
+        } catch (const exception& err) {
+          m_log.err("Error in X event loop: %s", err.what());
+        }
+      }
+    });
+  }
 
   if (m_confwatch) {
     m_log.trace("controller: Attach config watch");
     m_confwatch->attach(IN_MODIFY | IN_IGNORED);
-    fds.emplace_back((fd_confwatch = m_confwatch->get_file_descriptor()));
+    watch_config();
   }
 
   if (m_ipc) {
-    fds.emplace_back((fd_ipc = m_ipc->get_file_descriptor()));
+    watch_ipc();
   }
 
   while (!g_terminate) {
-    fd_set readfds{};
-    FD_ZERO(&readfds);
-
-    int maxfd{0};
-    for (auto&& fd : fds) {
-      FD_SET(fd, &readfds);
-      maxfd = std::max(maxfd, fd);
-    }
-
-    // Wait until event is ready on one of the configured streams
-    int events = select(maxfd + 1, &readfds, nullptr, nullptr, nullptr);
-
-    // Check for errors
-    if (events == -1 || g_terminate || m_connection.connection_has_error()) {
+    // Wait until event is ready on one of the registered streams
+    if (!m_loop.dispatch() || g_terminate || (m_connection != nullptr && m_connection->connection_has_error())) {
       break;
     }
+  }
 
-    // Process event on the internal fd
-    if (m_queuefd[PIPE_READ] && FD_ISSET(static_cast<int>(*m_queuefd[PIPE_READ]), &readfds)) {
-      char buffer[BUFSIZ];
-      if (read(static_cast<int>(*m_queuefd[PIPE_READ]), &buffer, BUFSIZ) == -1) {
-        m_log.err("Failed to read from eventpipe (err: %s)", strerror(errno));
-      }
-    }
+  if (m_connection != nullptr) {
+    m_loop.remove(m_connection->get_file_descriptor());
+  }
+
+  if (m_confwatch) {
+    m_loop.remove(m_confwatch->get_file_descriptor());
+  }
+  if (m_ipc) {
+    m_loop.remove(m_ipc->get_file_descriptor());
+  }
+}
 
-    // Process event on the config inotify watch fd
+/**
+ * Register the config inotify watch with the event loop
+ */
+void controller::watch_config() {
+  m_loop.add(m_confwatch->get_file_descriptor(), EPOLLIN, [&](int fd, unsigned int) {
     unique_ptr<inotify_event> confevent;
-    if (fd_confwatch > -1 && FD_ISSET(fd_confwatch, &readfds) && (confevent = m_confwatch->await_match())) {
-      if (confevent->mask & IN_IGNORED) {
-        // IN_IGNORED: file was deleted or filesystem was unmounted
-        //
-        // This happens in some configurations of vim when a file is saved,
-        // since it is not actually issuing calls to write() but rather
-        // moves a file into the original's place after moving the original
-        // file to a different location (and subsequently deleting it).
-        //
-        // We need to re-attach the watch to the new file in this case.
-        fds.erase(std::remove_if(fds.begin(), fds.end(), [fd_confwatch](int fd) { return fd == fd_confwatch; }), fds.end());
-        m_confwatch = inotify_util::make_watch(m_confwatch->path());
-        m_confwatch->attach(IN_MODIFY | IN_IGNORED);
-        fds.emplace_back((fd_confwatch = m_confwatch->get_file_descriptor()));
-      }
-      m_log.info("Configuration file changed");
-      g_terminate = 1;
-      g_reload = 1;
+    if (!(confevent = m_confwatch->await_match())) {
+      return;
     }
-
-    // Process event on the xcb connection fd
-    if (fd_connection > -1 && FD_ISSET(fd_connection, &readfds)) {
-      shared_ptr<xcb_generic_event_t> evt{};
-      while ((evt = shared_ptr<xcb_generic_event_t>(xcb_poll_for_event(m_connection), free)) != nullptr) {
-        try {
-          m_connection.dispatch_event(evt);
-        } catch (xpp::connection_error& err) {
-          m_log.err("X connection error, terminating... (what: %s)", m_connection.error_str(err.code()));
-        } catch (const exception& err) {
-          m_log.err("Error in X event loop: %s", err.what());
-        }
-      }
+    if (confevent->mask & IN_IGNORED) {
+      // IN_IGNORED: file was deleted or filesystem was unmounted
+      //
+      // This happens in some configurations of vim when a file is saved,
+      // since it is not actually issuing calls to write() but rather
+      // moves a file into the original's place after moving the original
+      // file to a different location (and subsequently deleting it).
+      //
+      // We need to re-attach the watch to the new file in this case.
+      m_loop.remove(fd);
+      m_confwatch = inotify_util::make_watch(m_confwatch->path());
+      m_confwatch->attach(IN_MODIFY | IN_IGNORED);
+      watch_config();
     }
+    m_log.info("Configuration file changed");
+    g_terminate = 1;
+    g_reload = 1;
+  });
+}
 
-    // Process event on the ipc fd
-    if (fd_ipc > -1 && FD_ISSET(fd_ipc, &readfds)) {
-      m_ipc->receive_message();
-      fds.erase(std::remove_if(fds.begin(), fds.end(), [fd_ipc](int fd) { return fd == fd_ipc; }), fds.end());
-      fds.emplace_back((fd_ipc = m_ipc->get_file_descriptor()));
-    }
-  }
+/**
+ * Register the ipc channel with the event loop
+ *
+ * The channel is reopened after each message,
+ * so the new fd has to be registered again
+ */
+void controller::watch_ipc() {
+  m_loop.add(m_ipc->get_file_descriptor(), EPOLLIN, [&](int fd, unsigned int) {
+    m_loop.remove(fd);
+    m_ipc->receive_message();
+    watch_ipc();
+  });
 }
 
 /**
@@ -345,7 +431,16 @@ void controller::process_eventqueue() {
 
   while (!g_terminate) {
     event evt{};
-    m_queue.wait_dequeue(evt);
+    auto now = chrono::steady_clock::now();
+
+    if (m_frame_pending && now >= m_frame_due) {
+      draw_frame();
+      continue;
+    } else if (!m_frame_pending) {
+      m_queue.wait_dequeue(evt);
+    } else if (!m_queue.wait_dequeue_timed(evt, m_frame_due - now)) {
+      continue;
+    }
 
     if (g_terminate) {
       break;
@@ -357,46 +452,54 @@ void controller::process_eventqueue() {
       }
     } else if (evt.type == event_type::INPUT) {
       process_inputdata();
-    } else if (evt.type == event_type::UPDATE && evt.flag) {
-      process_update(true);
+    } else if (evt.type == event_type::UPDATE) {
+      schedule_frame(evt.flag);
+    } else if (evt.type == event_type::CHECK) {
+      on(signals::eventqueue::check_state{});
+    } else if (evt.type == event_type::COMMAND) {
+      process_commands();
     } else {
-      event next{};
-      size_t swallowed{0};
-      while (swallowed++ < m_swallow_limit && m_queue.wait_dequeue_timed(next, m_swallow_update)) {
-        if (next.type == event_type::QUIT) {
-          evt = next;
-          break;
-        } else if (next.type == event_type::INPUT) {
-          evt = next;
-          break;
-        } else if (evt.type != next.type) {
-          enqueue(move(next));
-          break;
-        } else {
-          m_log.trace_x("controller: Swallowing event within timeframe");
-          evt = next;
-        }
-      }
-
-      if (evt.type == event_type::UPDATE) {
-        process_update(evt.flag);
-      } else if (evt.type == event_type::INPUT) {
-        process_inputdata();
-      } else if (evt.type == event_type::QUIT) {
-        if (evt.flag) {
-          on(signals::eventqueue::exit_reload{});
-        } else {
-          on(signals::eventqueue::exit_terminate{});
-        }
-      } else if (evt.type == event_type::CHECK) {
-        on(signals::eventqueue::check_state{});
-      } else {
-        m_log.warn("Unknown event type for enqueued event (%d)", evt.type);
-      }
+      m_log.warn("Unknown event type for enqueued event (%d)", evt.type);
     }
   }
 }
 
+/**
+ * Merge an update into the next frame
+ *
+ * The first change after the bar has been idle for a whole frame
+ * interval is drawn right away. Changes arriving within the interval
+ * are merged and drawn once it has passed.
+ *
+ * With a frame deadline, every further change merged into the pending
+ * frame postpones it by another interval so that a burst of changes
+ * ends up in a single frame, but never past the deadline counted from
+ * the first change. The frame-rate cap holds in either case.
+ */
+void controller::schedule_frame(bool force) {
+  auto now = chrono::steady_clock::now();
+  m_frame_force = m_frame_force || force;
+
+  if (!m_frame_pending) {
+    m_frame_pending = true;
+    m_frame_first = now;
+    m_frame_due = m_next_frame;
+  } else if (m_frame_deadline.count()) {
+    m_frame_due = std::max(m_next_frame, std::min(now + m_frame_interval, m_frame_first + m_frame_deadline));
+  }
+}
+
+/**
+ * Draw the changes merged into the pending frame
+ */
+void controller::draw_frame() {
+  bool force{m_frame_force};
+  m_frame_pending = false;
+  m_frame_force = false;
+  m_next_frame = chrono::steady_clock::now() + m_frame_interval;
+  process_update(force);
+}
+
 /**
  * Process stored input data
  */
@@ -412,116 +515,190 @@ void controller::process_inputdata() {
       }
     }
 
-    try {
-      m_log.info("Uncaught input event, forwarding to shell... (input: %s)", cmd);
+    m_log.info("Uncaught input event, forwarding to shell... (input: %s)", cmd);
 
-      if (m_command) {
-        m_log.warn("Terminating previous shell command");
-        m_command->terminate();
-      }
+    // Identical actions, e.g. repeated clicks on a module, don't overlap
+    string key{m_serialize_actions ? cmd : ""};
 
-      m_log.info("Executing shell command: %s", cmd);
-      m_command = command_util::make_command(move(cmd));
-      m_command->exec();
-      m_command.reset();
-      process_update(true);
-    } catch (const application_error& err) {
-      m_log.err("controller: Error while forwarding input to shell -> %s", err.what());
+    m_spawner->spawn(move(cmd),
+        [&](const string& command, int status) {
+          {
+            std::lock_guard<std::mutex> guard(m_exitedlock);
+            m_exited.emplace_back(command, status);
+          }
+          enqueue(make_command_evt());
+        },
+        move(key));
+  }
+}
+
+/**
+ * Report the exit status of finished shell commands
+ */
+void controller::process_commands() {
+  vector<pair<string, int>> exited;
+  {
+    std::lock_guard<std::mutex> guard(m_exitedlock);
+    exited.swap(m_exited);
+  }
+
+  for (const auto& command : exited) {
+    if (command.second != EXIT_SUCCESS) {
+      m_log.warn("Shell command exited with status %i (cmd: %s)", command.second, command.first);
+    } else {
+      m_log.info("Shell command finished (cmd: %s)", command.first);
     }
   }
+
+  // The command might have changed the state shown by the modules
+  schedule_frame(true);
 }
 
 /**
  * Process eventqueue update event
+ *
+ * Only the modules that broadcasted a change since the last
+ * update are asked for their contents. Blocks that don't contain
+ * any changed module are reused from the previous update.
  */
 bool controller::process_update(bool force) {
-  const bar_settings& bar{m_bar->settings()};
-  string contents;
-  string separator{bar.separator};
-  string padding_left(bar.padding.left, ' ');
-  string padding_right(bar.padding.right, ' ');
-  string margin_left(bar.module_margin.left, ' ');
-  string margin_right(bar.module_margin.right, ' ');
+  std::unordered_set<string> dirty;
+  {
+    std::lock_guard<std::mutex> guard(m_dirtylock);
+    dirty.swap(m_dirty);
+  }
+
+  bool snapshot{false};
+
+  for (const auto& name : dirty) {
+    m_snapshot_pending.erase(name);
+  }
+
+  // Ask each changed module for its contents once, no matter how many bars show it
+  std::map<modules::module_interface*, display_list> contents;
 
-  for (const auto& block : m_modules) {
-    string block_contents;
-    bool is_left = false;
-    bool is_center = false;
-    bool is_right = false;
-    bool is_first = true;
-
-    if (block.first == alignment::LEFT) {
-      is_left = true;
-    } else if (block.first == alignment::CENTER) {
-      is_center = true;
-    } else if (block.first == alignment::RIGHT) {
-      is_right = true;
+  for (const auto& module : m_modules) {
+    if (!module->running()) {
+      m_snapshot_pending.erase(module->name());
+      continue;
+    } else if (!force && dirty.find(module->name()) == dirty.end()) {
+      continue;
     }
 
-    for (const auto& module : block.second) {
-      if (!module->running()) {
-        continue;
-      }
+    display_list module_contents;
 
-      string module_contents;
+    try {
+      module_contents = module->contents();
+    } catch (const exception& err) {
+      m_log.err("Failed to get contents for \"%s\" (err: %s)", module->name(), err.what());
+    }
 
-      try {
-        module_contents = module->contents();
-      } catch (const exception& err) {
-        m_log.err("Failed to get contents for \"%s\" (err: %s)", module->name(), err.what());
-      }
+    contents.emplace(module.get(), move(module_contents));
+  }
 
-      if (module_contents.empty()) {
-        continue;
-      }
+  // Take the snapshot as soon as every module has produced its first output
+  std::unique_lock<std::mutex> snapshot_guard(m_snapshotlock);
+  if (!m_snapshot_dst.empty() && (m_snapshot_pending.empty() || m_snapshot_timeout)) {
+    if (!m_snapshot_pending.empty()) {
+      m_log.warn("Taking snapshot before all modules produced output (pending: %s)",
+          string_util::join(vector<string>(m_snapshot_pending.begin(), m_snapshot_pending.end()), ", "));
+    }
+    string dst{move(m_snapshot_dst)};
+    m_snapshot_dst.clear();
+    snapshot_guard.unlock();
 
-      if (!block_contents.empty() && !margin_right.empty()) {
-        block_contents += margin_right;
-      }
+    // The timeout timer is left to expire, it's closed by the main thread
+    m_sig.emit(signals::ui::request_snapshot{move(dst)});
+    snapshot = true;
+  } else {
+    snapshot_guard.unlock();
+  }
 
-      if (!block_contents.empty() && !separator.empty()) {
-        block_contents += separator;
-      }
+  for (auto&& hosted : m_bars) {
+    update_bar(hosted, contents, force || snapshot);
+  }
+
+  // There is nothing left to do when rendering offscreen
+  if (snapshot && m_connection == nullptr) {
+    enqueue(make_quit_evt(false));
+  }
+
+  return true;
+}
+
+/**
+ * Fan out the fetched module contents to given bar and redraw it if needed
+ *
+ * @return true if the bar was redrawn
+ */
+bool controller::update_bar(
+    hosted_bar& hosted, const std::map<modules::module_interface*, display_list>& contents, bool force) {
+  const bar_settings bar{hosted.instance->settings()};
+  bool changed{force};
+
+  for (const auto& block : hosted.modules) {
+    auto& segments = hosted.segments[block.first];
+    bool block_changed{force};
+
+    for (size_t i = 0; i < block.second.size(); i++) {
+      const auto& module = block.second[i];
 
-      if (!block_contents.empty() && !margin_left.empty() && !(is_left && is_first)) {
-        block_contents += margin_left;
+      if (!module->running()) {
+        if (!segments[i].empty()) {
+          segments[i].clear();
+          block_changed = true;
+        }
+        continue;
       }
 
-      block_contents.reserve(module_contents.size());
-      block_contents += module_contents;
+      auto it = contents.find(module);
+
+      if (it == contents.end() || it->second == segments[i]) {
+        continue;
+      }
 
-      is_first = false;
+      segments[i] = it->second;
+      block_changed = true;
     }
 
-    if (block_contents.empty()) {
+    if (!block_changed) {
       continue;
-    } else if (is_left) {
-      contents += "%{l}";
-      contents += padding_left;
-    } else if (is_center) {
-      contents += "%{c}";
-    } else if (is_right) {
-      contents += "%{r}";
-      block_contents += padding_right;
     }
 
-    // Strip unnecessary reset tags
-    block_contents = string_util::replace_all(block_contents, "T-}%{T", "T");
-    block_contents = string_util::replace_all(block_contents, "B-}%{B#", "B#");
-    block_contents = string_util::replace_all(block_contents, "F-}%{F#", "F#");
-    block_contents = string_util::replace_all(block_contents, "U-}%{U#", "U#");
-    block_contents = string_util::replace_all(block_contents, "u-}%{u#", "u#");
-    block_contents = string_util::replace_all(block_contents, "o-}%{o#", "o#");
+    hosted.blocks[block.first] = compose_block(hosted, block.first);
 
-    // Join consecutive tags
-    contents += string_util::replace_all(block_contents, "}%{", " ");
+    if (m_writeback || m_record) {
+      hosted.markup[block.first] = builder::markup(bar, hosted.blocks[block.first]);
+    }
+
+    changed = true;
+  }
+
+  if (!changed) {
+    return false;
+  }
+
+  // Store the markup of the frame so that it can be replayed by the benchmarks
+  if (m_record && !m_writeback) {
+    for (const auto& block : hosted.markup) {
+      *m_record << block.second;
+    }
+    *m_record << std::endl;
   }
 
   try {
     if (!m_writeback) {
-      m_bar->parse(move(contents), force);
+      display_list frame;
+      for (const auto& block : hosted.blocks) {
+        frame.insert(frame.end(), block.second.begin(), block.second.end());
+      }
+      hosted.instance->draw(frame, force);
     } else {
-      std::cout << contents << std::endl;
+      string output;
+      for (const auto& block : hosted.markup) {
+        output += block.second;
+      }
+      std::cout << output << std::endl;
     }
   } catch (const exception& err) {
     m_log.err("Failed to update bar contents (reason: %s)", err.what());
@@ -530,10 +707,61 @@ bool controller::process_update(bool force) {
   return true;
 }
 
+/**
+ * Join the cached module segments of given alignment block
+ */
+display_list controller::compose_block(const hosted_bar& hosted, alignment align) const {
+  const bar_settings bar{hosted.instance->settings()};
+  display_list commands;
+  string margin_left(bar.module_margin.left, ' ');
+  string margin_right(bar.module_margin.right, ' ');
+  bool is_first = true;
+
+  for (const auto& segment : hosted.segments.at(align)) {
+    if (segment.empty()) {
+      continue;
+    }
+
+    if (!is_first && !margin_right.empty()) {
+      commands.emplace_back(drawcmd{drawtype::TEXT, 0U, 0, margin_right});
+    }
+
+    if (!is_first && !hosted.separator.empty()) {
+      commands.insert(commands.end(), hosted.separator.begin(), hosted.separator.end());
+    }
+
+    if (!is_first && !margin_left.empty()) {
+      commands.emplace_back(drawcmd{drawtype::TEXT, 0U, 0, margin_left});
+    }
+
+    commands.insert(commands.end(), segment.begin(), segment.end());
+
+    is_first = false;
+  }
+
+  if (commands.empty()) {
+    return commands;
+  }
+
+  commands.emplace(commands.begin(), drawcmd{drawtype::ALIGNMENT, 0U, static_cast<int>(align)});
+
+  if (align == alignment::LEFT && bar.padding.left) {
+    commands.emplace(commands.begin() + 1, drawcmd{drawtype::TEXT, 0U, 0, string(bar.padding.left, ' ')});
+  } else if (align == alignment::RIGHT && bar.padding.right) {
+    commands.emplace_back(drawcmd{drawtype::TEXT, 0U, 0, string(bar.padding.right, ' ')});
+  }
+
+  return commands;
+}
+
 /**
  * Process broadcast events
  */
-bool controller::on(const signals::eventqueue::notify_change&) {
+bool controller::on(const signals::eventqueue::notify_change& evt) {
+  {
+    std::lock_guard<std::mutex> guard(m_dirtylock);
+    m_dirty.emplace(evt.cast());
+  }
   return enqueue(make_update_evt(false));
 }
 
@@ -564,11 +792,9 @@ bool controller::on(const signals::eventqueue::exit_reload&) {
  * Process eventqueue check event
  */
 bool controller::on(const signals::eventqueue::check_state&) {
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      if (module->running()) {
-        return true;
-      }
+  for (const auto& module : m_modules) {
+    if (module->running()) {
+      return true;
     }
   }
   m_log.warn("No running modules...");
@@ -581,16 +807,28 @@ bool controller::on(const signals::eventqueue::check_state&) {
  */
 bool controller::on(const signals::ui::ready&) {
   m_process_events = true;
-  enqueue(make_update_evt(true));
 
-  if (!m_snapshot_dst.empty()) {
-    m_threads.emplace_back(thread([&] {
-      this_thread::sleep_for(3s);
-      m_sig.emit(signals::ui::request_snapshot{move(m_snapshot_dst)});
-      enqueue(make_update_evt(true));
-    }));
+  // Don't wait forever for modules that never produce any output. The timer
+  // is set up before the update gets queued, which may take the snapshot.
+  {
+    std::lock_guard<std::mutex> guard(m_snapshotlock);
+
+    if (!m_snapshot_dst.empty() && m_snapshot_timer == -1) {
+      auto timeout = m_conf.get("settings", "snapshot-timeout", chrono::milliseconds{10s});
+      m_snapshot_timer = m_loop.add_timer(timeout,
+          [&] {
+            std::lock_guard<std::mutex> timer_guard(m_snapshotlock);
+            if (!m_snapshot_dst.empty()) {
+              m_snapshot_timeout = true;
+              enqueue(make_update_evt(true));
+            }
+          },
+          false);
+    }
   }
 
+  enqueue(make_update_evt(true));
+
   // let the event bubble
   return false;
 }
@@ -640,6 +878,10 @@ bool controller::on(const signals::ipc::command& evt) {
     enqueue(make_quit_evt(false));
   } else if (command == "restart") {
     enqueue(make_quit_evt(true));
+  } else if (command == "stats") {
+    for (const auto& module : m_modules) {
+      m_log.info("%s: Suppressed %lu redundant updates", module->name(), module->suppressed_updates());
+    }
   } else {
     m_log.warn("\"%s\" is not a valid ipc command", command);
   }
@@ -653,15 +895,13 @@ bool controller::on(const signals::ipc::command& evt) {
 bool controller::on(const signals::ipc::hook& evt) {
   string hook{evt.cast()};
 
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      if (!module->running()) {
-        continue;
-      }
-      auto ipc = dynamic_cast<ipc_module*>(module.get());
-      if (ipc != nullptr) {
-        ipc->on_message(hook);
-      }
+  for (const auto& module : m_modules) {
+    if (!module->running()) {
+      continue;
+    }
+    auto ipc = dynamic_cast<ipc_module*>(module.get());
+    if (ipc != nullptr) {
+      ipc->on_message(hook);
     }
   }
 
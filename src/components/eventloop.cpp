@@ -0,0 +1,209 @@
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "components/eventloop.hpp"
+#include "components/logger.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+/**
+ * Maximum number of events to pick up per call to epoll_wait
+ */
+static constexpr int MAX_EVENTS{32};
+
+/**
+ * Create instance
+ */
+eventloop::make_type eventloop::make() {
+  return static_cast<eventloop&>(*factory_util::singleton<eventloop>(logger::make()));
+}
+
+/**
+ * Construct the reactor and register the internal wakeup channel
+ */
+eventloop::eventloop(const logger& logger) : m_log(logger) {
+  if ((m_epollfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+    throw system_error("Failed to create epoll instance");
+  }
+  if ((m_eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) {
+    throw system_error("Failed to create wakeup channel");
+  }
+
+  add(m_eventfd, EPOLLIN, [](int fd, unsigned int) {
+    uint64_t count;
+    while (read(fd, &count, sizeof(count)) > 0) {
+      ;
+    }
+  });
+}
+
+/**
+ * Deconstruct the reactor
+ */
+eventloop::~eventloop() {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_handlers.clear();
+  if (m_eventfd != -1) {
+    close(m_eventfd);
+  }
+  if (m_epollfd != -1) {
+    close(m_epollfd);
+  }
+}
+
+/**
+ * Start watching given file descriptor
+ *
+ * @note The callback is invoked from the thread calling `dispatch()`
+ */
+void eventloop::add(int fd, unsigned int events, fd_callback cb, bool edge_triggered) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_handlers[fd] = make_shared<fd_callback>(move(cb));
+  try {
+    ctl(EPOLL_CTL_ADD, fd, events, edge_triggered);
+  } catch (const eventloop_error& err) {
+    m_handlers.erase(fd);
+    throw;
+  }
+}
+
+/**
+ * Change the events reported for an already registered file descriptor
+ */
+void eventloop::modify(int fd, unsigned int events, bool edge_triggered) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  ctl(EPOLL_CTL_MOD, fd, events, edge_triggered);
+}
+
+/**
+ * Stop watching given file descriptor
+ *
+ * This must be called before the descriptor is closed
+ * in case it has been duplicated
+ */
+void eventloop::remove(int fd) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  if (m_handlers.erase(fd)) {
+    epoll_ctl(m_epollfd, EPOLL_CTL_DEL, fd, nullptr);
+  }
+}
+
+/**
+ * Register a timer that invokes the callback when it expires
+ *
+ * @return Timer handle used to unregister the timer
+ */
+int eventloop::add_timer(duration interval, timer_callback cb, bool repeat) {
+  int timer{timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)};
+
+  if (timer == -1) {
+    throw system_error("Failed to create timer");
+  }
+
+  struct itimerspec spec {};
+  spec.it_value.tv_sec = chrono::duration_cast<chrono::seconds>(interval).count();
+  spec.it_value.tv_nsec = chrono::duration_cast<chrono::nanoseconds>(interval % chrono::seconds{1}).count();
+
+  // A zero value would disarm the timer
+  if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+    spec.it_value.tv_nsec = 1;
+  }
+  if (repeat) {
+    spec.it_interval = spec.it_value;
+  }
+
+  if (timerfd_settime(timer, 0, &spec, nullptr) == -1) {
+    close(timer);
+    throw system_error("Failed to arm timer");
+  }
+
+  add(timer, EPOLLIN, [cb](int fd, unsigned int) {
+    uint64_t expirations{0};
+    if (read(fd, &expirations, sizeof(expirations)) > 0 && expirations > 0) {
+      cb();
+    }
+  });
+
+  return timer;
+}
+
+/**
+ * Unregister and release given timer
+ */
+void eventloop::remove_timer(int timer) {
+  remove(timer);
+  close(timer);
+}
+
+/**
+ * Wait for events and invoke the callbacks of the ready descriptors
+ *
+ * @return false if the wait failed
+ */
+bool eventloop::dispatch(int timeout_ms) {
+  struct epoll_event events[MAX_EVENTS];
+  int count{epoll_wait(m_epollfd, events, MAX_EVENTS, timeout_ms)};
+
+  if (count == -1) {
+    if (errno != EINTR) {
+      m_log.err("eventloop: epoll_wait failed (err: %s)", strerror(errno));
+      return false;
+    }
+    return true;
+  }
+
+  for (int i = 0; i < count; i++) {
+    int fd{events[i].data.fd};
+    shared_ptr<fd_callback> handler;
+
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      auto it = m_handlers.find(fd);
+      if (it == m_handlers.end()) {
+        // Removed by a previous callback in this batch
+        continue;
+      }
+      handler = it->second;
+    }
+
+    (*handler)(fd, events[i].events);
+  }
+
+  return true;
+}
+
+/**
+ * Interrupt a blocking call to `dispatch()`
+ *
+ * @note Only calls write(2), which makes it safe to use from signal handlers
+ */
+void eventloop::wakeup() const {
+  uint64_t value{1};
+  if (write(m_eventfd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+    m_log.err("eventloop: Failed to write to wakeup channel (err: %s)", strerror(errno));
+  }
+}
+
+/**
+ * Get the eventfd used to interrupt the loop
+ */
+int eventloop::get_wakeup_fd() const {
+  return m_eventfd;
+}
+
+/**
+ * Wrapper for epoll_ctl
+ */
+void eventloop::ctl(int op, int fd, unsigned int events, bool edge_triggered) {
+  struct epoll_event evt {};
+  evt.events = events | (edge_triggered ? EPOLLET : 0U);
+  evt.data.fd = fd;
+
+  if (epoll_ctl(m_epollfd, op, fd, &evt) == -1) {
+    throw eventloop_error("Failed to register fd " + to_string(fd) + " (reason: " + strerror(errno) + ")");
+  }
+}
+
+POLYBAR_NS_END
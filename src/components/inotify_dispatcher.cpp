@@ -0,0 +1,115 @@
+#include <unistd.h>
+#include <algorithm>
+
+#include "components/eventloop.hpp"
+#include "components/inotify_dispatcher.hpp"
+#include "components/logger.hpp"
+#include "errors.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+/**
+ * Create instance
+ */
+inotify_dispatcher::make_type inotify_dispatcher::make() {
+  return static_cast<inotify_dispatcher&>(
+      *factory_util::singleton<inotify_dispatcher>(logger::make(), eventloop::make()));
+}
+
+/**
+ * Construct dispatcher and register the inotify descriptor with the event loop
+ */
+inotify_dispatcher::inotify_dispatcher(const logger& logger, eventloop& loop) : m_log(logger), m_loop(loop) {
+  if ((m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1) {
+    throw system_error("Failed to allocate inotify fd");
+  }
+
+  m_loop.add(m_fd, EPOLLIN, [this](int, unsigned int) { read_events(); });
+}
+
+/**
+ * Deconstruct dispatcher
+ */
+inotify_dispatcher::~inotify_dispatcher() {
+  m_loop.remove(m_fd);
+  close(m_fd);
+}
+
+/**
+ * Subscribe to events for given path
+ *
+ * @note The callback is invoked from the thread running the event loop
+ */
+inotify_dispatcher::subscription_id inotify_dispatcher::add(const string& path, int mask, callback cb) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  // Extend the mask of an existing watch on the same path instead of replacing it
+  int wd{inotify_add_watch(m_fd, path.c_str(), mask | IN_MASK_ADD)};
+
+  if (wd == -1) {
+    throw system_error("Failed to attach inotify watch for " + path);
+  }
+
+  m_log.trace("inotify: Subscribed to %s (wd: %i)", path, wd);
+  m_subscriptions.emplace(m_nextid, subscription{path, wd, mask, move(cb)});
+
+  return m_nextid++;
+}
+
+/**
+ * Cancel subscription
+ *
+ * The watch is removed once it has no subscribers left
+ */
+void inotify_dispatcher::remove(subscription_id id) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto it = m_subscriptions.find(id);
+
+  if (it == m_subscriptions.end()) {
+    return;
+  }
+
+  int wd{it->second.wd};
+  m_subscriptions.erase(it);
+
+  if (std::none_of(m_subscriptions.begin(), m_subscriptions.end(), [wd](const auto& s) { return s.second.wd == wd; })) {
+    inotify_rm_watch(m_fd, wd);
+  }
+}
+
+/**
+ * Drain the inotify descriptor and notify the subscribers
+ */
+void inotify_dispatcher::read_events() {
+  alignas(::inotify_event) char buffer[4096];
+  ssize_t bytes;
+
+  while ((bytes = read(m_fd, buffer, sizeof(buffer))) > 0) {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for (ssize_t len = 0; len < bytes;) {
+      auto* e = reinterpret_cast<::inotify_event*>(&buffer[len]);
+      len += sizeof(*e) + e->len;
+
+      inotify_event event{};
+      event.wd = e->wd;
+      event.cookie = e->cookie;
+      event.is_dir = e->mask & IN_ISDIR;
+      event.mask = e->mask;
+
+      for (auto&& s : m_subscriptions) {
+        if (s.second.wd == e->wd && (s.second.mask & e->mask)) {
+          event.filename = e->len ? e->name : s.second.path;
+          s.second.cb(event);
+        }
+      }
+    }
+  }
+
+  if (bytes == -1 && errno != EAGAIN) {
+    m_log.err("inotify: Failed to read events (err: %s)", strerror(errno));
+  }
+}
+
+POLYBAR_NS_END
@@ -3,6 +3,7 @@
 
 #include "components/ipc.hpp"
 #include "components/logger.hpp"
+#include "errors.hpp"
 #include "events/signal.hpp"
 #include "events/signal_emitter.hpp"
 #include "utils/factory.hpp"
@@ -1,9 +1,9 @@
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 
 #include "components/parser.hpp"
 #include "components/types.hpp"
-#include "events/signal.hpp"
-#include "events/signal_emitter.hpp"
 #include "settings.hpp"
 #include "utils/color.hpp"
 #include "utils/factory.hpp"
@@ -14,34 +14,38 @@
 
 POLYBAR_NS
 
-using namespace signals::parser;
-
 /**
  * Create instance
  */
 parser::make_type parser::make() {
-  return factory_util::unique<parser>(signal_emitter::make());
+  return factory_util::unique<parser>();
 }
 
 /**
- * Construct parser instance
+ * Process input string and append the resulting draw commands to output
+ *
+ * The input is scanned once from left to right. Tags and text runs
+ * are referenced by their offsets into data, so the only copies made
+ * are the text runs and action commands stored in the output.
  */
-parser::parser(signal_emitter& emitter) : m_sig(emitter) {}
+void parser::parse(const bar_settings& bar, const string& data, display_list& output) {
+  const size_t length{data.size()};
+  size_t pos{0};
 
-/**
- * Process input string
- */
-void parser::parse(const bar_settings& bar, string data) {
-  while (!data.empty()) {
-    size_t pos{string::npos};
-
-    if (data.compare(0, 2, "%{") == 0 && (pos = data.find('}')) != string::npos) {
-      codeblock(data.substr(2, pos - 2), bar);
-      data.erase(0, pos + 1);
-    } else if ((pos = data.find("%{")) != string::npos) {
-      data.erase(0, text(data.substr(0, pos)));
+  m_actions.clear();
+
+  while (pos < length) {
+    size_t end{string::npos};
+
+    if (data.compare(pos, 2, "%{") == 0 && (end = data.find('}', pos + 2)) != string::npos) {
+      codeblock(data, pos + 2, end, bar, output);
+      pos = end + 1;
+    } else if ((end = data.find("%{", pos + 1)) != string::npos) {
+      text(data, pos, end - pos, output);
+      pos = end;
     } else {
-      data.erase(0, text(data.substr(0)));
+      text(data, pos, length - pos, output);
+      pos = length;
     }
   }
 
@@ -52,102 +56,102 @@ void parser::parse(const bar_settings& bar, string data) {
 
 /**
  * Process contents within tag blocks, i.e: %{...}
+ *
+ * @param pos Offset of the first character after the opening %{
+ * @param end Offset of the closing }
  */
-void parser::codeblock(string&& data, const bar_settings& bar) {
-  size_t pos;
-
-  while (data.length()) {
-    data = string_util::ltrim(move(data), ' ');
+void parser::codeblock(const string& data, size_t pos, size_t end, const bar_settings& bar, display_list& output) {
+  while (pos < end) {
+    while (pos < end && data[pos] == ' ') {
+      pos++;
+    }
 
-    if (data.empty()) {
+    if (pos == end) {
       break;
     }
 
-    char tag{data[0]};
-    string value;
-
-    // Remove the tag
-    data.erase(0, 1);
+    char tag{data[pos++]};
+    size_t len{0};
 
-    if ((pos = data.find_first_of(" }")) != string::npos) {
-      value = data.substr(0, pos);
-    } else {
-      value = data;
+    while (pos + len < end && data[pos + len] != ' ') {
+      len++;
     }
 
     switch (tag) {
       case 'B':
-        m_sig.emit(change_background{parse_color(value, 0)});
+        output.emplace_back(drawcmd{drawtype::BACKGROUND, parse_color(data, pos, len, 0)});
         break;
 
       case 'F':
-        m_sig.emit(change_foreground{parse_color(value, bar.foreground)});
+        output.emplace_back(drawcmd{drawtype::FOREGROUND, parse_color(data, pos, len, bar.foreground)});
         break;
 
       case 'T':
-        m_sig.emit(change_font{parse_fontindex(value)});
+        output.emplace_back(drawcmd{drawtype::FONT, 0U, parse_fontindex(data, pos, len)});
         break;
 
       case 'U':
-        m_sig.emit(change_underline{parse_color(value, bar.underline.color)});
-        m_sig.emit(change_overline{parse_color(value, bar.overline.color)});
+        output.emplace_back(drawcmd{drawtype::UNDERLINE, parse_color(data, pos, len, bar.underline.color)});
+        output.emplace_back(drawcmd{drawtype::OVERLINE, parse_color(data, pos, len, bar.overline.color)});
         break;
 
       case 'u':
-        m_sig.emit(change_underline{parse_color(value, bar.underline.color)});
+        output.emplace_back(drawcmd{drawtype::UNDERLINE, parse_color(data, pos, len, bar.underline.color)});
         break;
 
       case 'o':
-        m_sig.emit(change_overline{parse_color(value, bar.overline.color)});
+        output.emplace_back(drawcmd{drawtype::OVERLINE, parse_color(data, pos, len, bar.overline.color)});
         break;
 
       case 'R':
-        m_sig.emit(change_background{parse_color(value, bar.foreground)});
-        m_sig.emit(change_foreground{parse_color(value, bar.background)});
+        output.emplace_back(drawcmd{drawtype::BACKGROUND, parse_color(data, pos, len, bar.foreground)});
+        output.emplace_back(drawcmd{drawtype::FOREGROUND, parse_color(data, pos, len, bar.background)});
         break;
 
       case 'O':
-        m_sig.emit(offset_pixel{static_cast<int>(std::atoi(value.c_str()))});
+        output.emplace_back(drawcmd{drawtype::OFFSET, 0U, len ? std::atoi(&data[pos]) : 0});
         break;
 
       case 'l':
-        m_sig.emit(change_alignment{alignment::LEFT});
+        output.emplace_back(drawcmd{drawtype::ALIGNMENT, 0U, static_cast<int>(alignment::LEFT)});
         break;
 
       case 'c':
-        m_sig.emit(change_alignment{alignment::CENTER});
+        output.emplace_back(drawcmd{drawtype::ALIGNMENT, 0U, static_cast<int>(alignment::CENTER)});
         break;
 
       case 'r':
-        m_sig.emit(change_alignment{alignment::RIGHT});
+        output.emplace_back(drawcmd{drawtype::ALIGNMENT, 0U, static_cast<int>(alignment::RIGHT)});
         break;
 
       case '+':
-        m_sig.emit(attribute_set{parse_attr(value[0])});
+        output.emplace_back(
+            drawcmd{drawtype::ATTRIBUTE_SET, 0U, static_cast<int>(parse_attr(len ? data[pos] : '\0'))});
         break;
 
       case '-':
-        m_sig.emit(attribute_unset{parse_attr(value[0])});
+        output.emplace_back(
+            drawcmd{drawtype::ATTRIBUTE_UNSET, 0U, static_cast<int>(parse_attr(len ? data[pos] : '\0'))});
         break;
 
       case '!':
-        m_sig.emit(attribute_toggle{parse_attr(value[0])});
+        output.emplace_back(
+            drawcmd{drawtype::ATTRIBUTE_TOGGLE, 0U, static_cast<int>(parse_attr(len ? data[pos] : '\0'))});
         break;
 
       case 'A':
-        if (isdigit(data[0]) || data[0] == ':') {
-          value = parse_action_cmd(data.substr(data[0] != ':' ? 1 : 0));
-          mousebtn btn = parse_action_btn(data);
-          m_actions.push_back(static_cast<int>(btn));
-          m_sig.emit(action_begin{action{btn, value}});
+        if (pos < end && (isdigit(data[pos]) || data[pos] == ':')) {
+          mousebtn btn{parse_action_btn(data[pos])};
+          string cmd{parse_action_cmd(data, data[pos] != ':' ? pos + 1 : pos, end)};
 
-          // make sure we strip the correct length (btn+wrapping colons)
-          if (value[0] != ':') {
-            value += "0";
-          }
-          value += "::";
+          // Skip the button index and the wrapping colons
+          len = cmd.length() + 2 + (cmd.empty() || cmd[0] != ':' ? 1 : 0);
+
+          m_actions.push_back(static_cast<int>(btn));
+          output.emplace_back(drawcmd{drawtype::ACTION_BEGIN, 0U, static_cast<int>(btn), move(cmd)});
         } else if (!m_actions.empty()) {
-          m_sig.emit(action_end{parse_action_btn(value)});
+          mousebtn btn{parse_action_btn(len ? data[pos] : '\0')};
+          output.emplace_back(drawcmd{drawtype::ACTION_END, 0U, static_cast<int>(btn)});
           m_actions.pop_back();
         }
         break;
@@ -156,33 +160,28 @@ void parser::codeblock(string&& data, const bar_settings& bar) {
         throw unrecognized_token("Unrecognized token '" + string{tag} + "'");
     }
 
-    if (!data.empty()) {
-      data.erase(0, !value.empty() ? value.length() : 1);
-    }
+    pos += len ? len : 1;
   }
 }
 
 /**
  * Process text contents
  */
-size_t parser::text(string&& data) {
+void parser::text(const string& data, size_t pos, size_t len, display_list& output) {
+  output.emplace_back(drawcmd{drawtype::TEXT, 0U, 0, data.substr(pos, len)});
+
 #ifdef DEBUG_WHITESPACE
-  string::size_type p;
-  while ((p = data.find(' ')) != string::npos) {
-    data.replace(p, 1, "-"s);
-  }
+  std::replace(output.back().data.begin(), output.back().data.end(), ' ', '-');
 #endif
-
-  m_sig.emit(signals::parser::text{forward<string>(data)});
-  return data.size();
 }
 
 /**
  * Process color hex string and convert it to the correct value
  */
-unsigned int parser::parse_color(const string& s, unsigned int fallback) {
-  if (!s.empty() && s[0] != '-') {
-    return color_util::parse(s, fallback);
+unsigned int parser::parse_color(const string& data, size_t pos, size_t len, unsigned int fallback) {
+  if (len && data[pos] != '-') {
+    // Fits within the small string buffer, i.e. no heap allocation
+    return color_util::parse(data.substr(pos, len), fallback);
   }
   return fallback;
 }
@@ -190,16 +189,11 @@ unsigned int parser::parse_color(const string& s, unsigned int fallback) {
 /**
  * Process font index and convert it to the correct value
  */
-int parser::parse_fontindex(const string& s) {
-  if (s.empty() || s[0] == '-') {
-    return 0;
-  }
-
-  try {
-    return std::stoul(s, nullptr, 10);
-  } catch (const std::invalid_argument& err) {
+int parser::parse_fontindex(const string& data, size_t pos, size_t len) {
+  if (!len || !isdigit(data[pos])) {
     return 0;
   }
+  return static_cast<int>(std::strtoul(&data[pos], nullptr, 10));
 }
 
 /**
@@ -219,11 +213,11 @@ attribute parser::parse_attr(const char attr) {
 /**
  * Process action button token and convert it to the correct value
  */
-mousebtn parser::parse_action_btn(const string& data) {
-  if (data[0] == ':') {
+mousebtn parser::parse_action_btn(const char btn) {
+  if (btn == ':') {
     return mousebtn::LEFT;
-  } else if (isdigit(data[0])) {
-    return static_cast<mousebtn>(data[0] - '0');
+  } else if (isdigit(btn)) {
+    return static_cast<mousebtn>(btn - '0');
   } else if (!m_actions.empty()) {
     return static_cast<mousebtn>(m_actions.back());
   } else {
@@ -233,22 +227,25 @@ mousebtn parser::parse_action_btn(const string& data) {
 
 /**
  * Process action command string
+ *
+ * @param pos Offset of the opening colon
+ * @param end Offset of the end of the enclosing tag block
  */
-string parser::parse_action_cmd(string&& data) {
-  if (data[0] != ':') {
+string parser::parse_action_cmd(const string& data, size_t pos, size_t end) {
+  if (pos >= end || data[pos] != ':') {
     return "";
   }
 
-  size_t end{1};
-  while ((end = data.find(':', end)) != string::npos && data[end - 1] == '\\') {
-    end++;
+  size_t cmd_end{pos + 1};
+  while ((cmd_end = data.find(':', cmd_end)) < end && data[cmd_end - 1] == '\\') {
+    cmd_end++;
   }
 
-  if (end == string::npos) {
+  if (cmd_end >= end) {
     return "";
   }
 
-  return data.substr(1, end - 1);
+  return data.substr(pos + 1, cmd_end - pos - 1);
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,158 @@
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <csignal>
+
+#include "components/eventloop.hpp"
+#include "components/logger.hpp"
+#include "components/reaper.hpp"
+#include "utils/factory.hpp"
+#include "utils/process.hpp"
+
+POLYBAR_NS
+
+/**
+ * Create instance
+ */
+reaper::make_type reaper::make() {
+  return static_cast<reaper&>(*factory_util::singleton<reaper>(logger::make(), eventloop::make()));
+}
+
+/**
+ * Construct reaper and fall back to SIGCHLD if pidfds aren't supported
+ */
+reaper::reaper(const logger& logger, eventloop& loop) : m_log(logger), m_loop(loop) {
+  int pidfd{process_util::open_pidfd(getpid())};
+
+  if (pidfd != -1) {
+    close(pidfd);
+    return;
+  }
+
+  m_log.trace("reaper: pidfd_open() not supported, using signalfd (err: %s)", strerror(errno));
+
+  sigset_t sigmask;
+  sigemptyset(&sigmask);
+  sigaddset(&sigmask, SIGCHLD);
+  pthread_sigmask(SIG_BLOCK, &sigmask, nullptr);
+
+  if ((m_signalfd = signalfd(-1, &sigmask, SFD_NONBLOCK | SFD_CLOEXEC)) == -1) {
+    throw system_error("Failed to create signalfd");
+  }
+
+  m_loop.add(m_signalfd, EPOLLIN, [this](int fd, unsigned int) {
+    struct signalfd_siginfo info;
+    while (read(fd, &info, sizeof(info)) > 0) {
+      ;
+    }
+    collect_all();
+  });
+}
+
+/**
+ * Deconstruct reaper
+ */
+reaper::~reaper() {
+  if (m_signalfd != -1) {
+    m_loop.remove(m_signalfd);
+    close(m_signalfd);
+  }
+}
+
+/**
+ * Notify the owner once the child has exited
+ *
+ * @param pidfd Descriptor referring to the child, -1 when pidfds aren't supported.
+ * It remains owned by the caller but must stay open while the child is watched
+ * @note The callback is invoked with the internal lock held and must not call back into the reaper
+ */
+void reaper::watch(pid_t pid, int pidfd, callback on_exit) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_children[pid] = child{pidfd, move(on_exit)};
+
+  if (pidfd != -1) {
+    m_loop.add(pidfd, EPOLLIN, [this, pid](int, unsigned int) {
+      std::lock_guard<std::mutex> guard(m_lock);
+      collect(pid, WNOHANG);
+    });
+  } else {
+    // The SIGCHLD may already have been consumed before the child was watched
+    collect(pid, WNOHANG);
+  }
+}
+
+/**
+ * Stop watching the child so that the caller can collect it itself
+ *
+ * @return false if the child has already been collected
+ */
+bool reaper::release(pid_t pid) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto it = m_children.find(pid);
+
+  if (it == m_children.end()) {
+    return false;
+  }
+  if (it->second.pidfd != -1) {
+    m_loop.remove(it->second.pidfd);
+  }
+
+  m_children.erase(it);
+  return true;
+}
+
+/**
+ * Block until all watched children have exited
+ */
+void reaper::wait_all() {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  if (!m_children.empty()) {
+    m_log.info("reaper: Waiting for %lu child process(es) to end", m_children.size());
+  }
+  while (!m_children.empty()) {
+    if (!collect(m_children.begin()->first, 0)) {
+      m_children.erase(m_children.begin());
+    }
+  }
+}
+
+/**
+ * Collect the child if it has exited and notify its owner
+ *
+ * @note Expects the lock to be held
+ */
+bool reaper::collect(pid_t pid, int waitflags) {
+  auto it = m_children.find(pid);
+  int status{0};
+
+  if (it == m_children.end() || process_util::wait_for_completion(pid, &status, waitflags) != pid) {
+    return false;
+  }
+
+  m_log.trace("reaper: Child process %d exited with status %d", pid, status);
+
+  if (it->second.pidfd != -1) {
+    m_loop.remove(it->second.pidfd);
+  }
+  if (it->second.on_exit) {
+    it->second.on_exit(status);
+  }
+
+  m_children.erase(it);
+  return true;
+}
+
+/**
+ * Collect all watched children that have exited
+ */
+void reaper::collect_all() {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  for (auto it = m_children.begin(); it != m_children.end();) {
+    pid_t pid{(it++)->first};
+    collect(pid, WNOHANG);
+  }
+}
+
+POLYBAR_NS_END
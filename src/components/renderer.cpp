@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "components/renderer.hpp"
 #include "cairo/context.hpp"
 #include "components/config.hpp"
@@ -18,12 +20,12 @@ static constexpr double BLOCK_GAP{20.0};
 /**
  * Create instance
  */
-renderer::make_type renderer::make(const bar_settings& bar) {
+renderer::make_type renderer::make(const bar_settings& bar, const config& conf, bool headless) {
   // clang-format off
   return factory_util::unique<renderer>(
-      connection::make(),
+      headless ? nullptr : &connection::make(),
       signal_emitter::make(),
-      config::make(),
+      conf,
       logger::make(),
       forward<decltype(bar)>(bar));
   // clang-format on
@@ -33,7 +35,7 @@ renderer::make_type renderer::make(const bar_settings& bar) {
  * Construct renderer instance
  */
 renderer::renderer(
-    connection& conn, signal_emitter& sig, const config& conf, const logger& logger, const bar_settings& bar)
+    connection* conn, signal_emitter& sig, const config& conf, const logger& logger, const bar_settings& bar)
     : m_connection(conn)
     , m_sig(sig)
     , m_conf(conf)
@@ -41,65 +43,9 @@ renderer::renderer(
     , m_bar(forward<const bar_settings&>(bar))
     , m_rect(m_bar.inner_area()) {
   m_sig.attach(this);
-  m_log.trace("renderer: Get TrueColor visual");
-  {
-    if ((m_visual = m_connection.visual_type(m_connection.screen(), 32)) == nullptr) {
-      m_log.err("No 32-bit TrueColor visual found...");
-
-      if ((m_visual = m_connection.visual_type(m_connection.screen(), 24)) == nullptr) {
-        m_log.err("No 24-bit TrueColor visual found...");
-      } else {
-        m_depth = 24;
-      }
-    }
-    if (m_visual == nullptr) {
-      throw application_error("No matching TrueColor");
-    }
-  }
 
-  m_log.trace("renderer: Allocate colormap");
-  {
-    m_colormap = m_connection.generate_id();
-    m_connection.create_colormap(XCB_COLORMAP_ALLOC_NONE, m_colormap, m_connection.screen()->root, m_visual->visual_id);
-  }
-
-  m_log.trace("renderer: Allocate output window");
-  {
-    // clang-format off
-    m_window = winspec(m_connection)
-      << cw_size(m_bar.size)
-      << cw_pos(m_bar.pos)
-      << cw_depth(m_depth)
-      << cw_visual(m_visual->visual_id)
-      << cw_class(XCB_WINDOW_CLASS_INPUT_OUTPUT)
-      << cw_params_back_pixel(0)
-      << cw_params_border_pixel(0)
-      << cw_params_backing_store(XCB_BACKING_STORE_WHEN_MAPPED)
-      << cw_params_colormap(m_colormap)
-      << cw_params_event_mask(XCB_EVENT_MASK_PROPERTY_CHANGE
-                             |XCB_EVENT_MASK_EXPOSURE
-                             |XCB_EVENT_MASK_BUTTON_PRESS)
-      << cw_params_override_redirect(m_bar.override_redirect)
-      << cw_flush(true);
-    // clang-format on
-  }
-
-  m_log.trace("renderer: Allocate window pixmaps");
-  {
-    m_pixmap = m_connection.generate_id();
-    m_connection.create_pixmap(m_depth, m_pixmap, m_window, m_bar.size.w, m_bar.size.h);
-  }
-
-  m_log.trace("renderer: Allocate graphic contexts");
-  {
-    unsigned int mask{0};
-    unsigned int value_list[32]{0};
-    xcb_params_gc_t params{};
-    XCB_AUX_ADD_PARAM(&mask, &params, foreground, m_bar.foreground);
-    XCB_AUX_ADD_PARAM(&mask, &params, graphics_exposures, 0);
-    connection::pack_values(mask, &params, value_list);
-    m_gcontext = m_connection.generate_id();
-    m_connection.create_gc(m_gcontext, m_pixmap, mask, value_list);
+  if (m_connection != nullptr) {
+    setup_window();
   }
 
   m_log.trace("renderer: Allocate alignment blocks");
@@ -111,7 +57,34 @@ renderer::renderer(
 
   m_log.trace("renderer: Allocate cairo components");
   {
-    m_surface = make_unique<cairo::xcb_surface>(m_connection, m_pixmap, m_visual, m_bar.size.w, m_bar.size.h);
+    auto backend = m_conf.get("settings", "render-backend", "xcb"s);
+
+    if (m_connection == nullptr) {
+      m_log.info("Drawing into offscreen image surface");
+      m_surface = make_unique<cairo::image_surface>(CAIRO_FORMAT_ARGB32, m_bar.size.w, m_bar.size.h);
+    } else if (backend == "shm") {
+#if WITH_XSHM
+      try {
+        shm_util::query_extension(*m_connection);
+        auto format = m_depth == 32 ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24;
+        auto stride = cairo_format_stride_for_width(format, m_bar.size.w);
+        m_shm = make_unique<shm_segment>(*m_connection, static_cast<size_t>(stride) * m_bar.size.h);
+        m_surface = make_unique<cairo::image_surface>(m_shm->data(), format, m_bar.size.w, m_bar.size.h, stride);
+        m_log.info("Drawing into MIT-SHM image surface");
+      } catch (const application_error& err) {
+        m_log.warn("Failed to set up MIT-SHM backend, falling back to xcb (reason: %s)", err.what());
+        m_shm.reset();
+      }
+#else
+      m_log.warn("Not built with MIT-SHM support, falling back to xcb");
+#endif
+    } else if (backend != "xcb") {
+      m_log.warn("Unknown render-backend \"%s\", falling back to xcb", backend);
+    }
+
+    if (!m_surface) {
+      m_surface = make_unique<cairo::xcb_surface>(*m_connection, m_pixmap, m_visual, m_bar.size.w, m_bar.size.h);
+    }
     m_context = make_unique<cairo::context>(*m_surface, m_log);
   }
 
@@ -130,8 +103,12 @@ renderer::renderer(
     }
 
     // dpi to be comptued
-    if (dpi_x <= 0 || dpi_y <= 0) {
-      auto screen = m_connection.screen();
+    if ((dpi_x <= 0 || dpi_y <= 0) && m_connection == nullptr) {
+      m_log.warn("Cannot compute dpi without an X server, using 96");
+      dpi_x = dpi_x <= 0 ? 96 : dpi_x;
+      dpi_y = dpi_y <= 0 ? 96 : dpi_y;
+    } else if (dpi_x <= 0 || dpi_y <= 0) {
+      auto screen = m_connection->screen();
       if (dpi_x <= 0) {
         dpi_x = screen->width_in_pixels * 25.4 / screen->width_in_millimeters;
       }
@@ -148,6 +125,9 @@ renderer::renderer(
       fonts.emplace_back("fixed");
     }
 
+    // A size of 0 disables the glyph cache
+    auto cache_size = m_conf.get("settings", "glyph-cache-size", size_t{256});
+
     for (const auto& f : fonts) {
       int offset{0};
       string pattern{f};
@@ -156,7 +136,7 @@ renderer::renderer(
         offset = std::atoi(pattern.substr(pos + 1).c_str());
         pattern.erase(pos);
       }
-      auto font = cairo::make_font(*m_context, string{pattern}, offset, dpi_x, dpi_y);
+      auto font = cairo::make_font(*m_context, string{pattern}, offset, dpi_x, dpi_y, cache_size);
       m_log.info("Loaded font \"%s\" (name=%s, offset=%i, file=%s)", pattern, font->name(), offset, font->file());
       *m_context << move(font);
     }
@@ -176,6 +156,79 @@ renderer::renderer(
  */
 renderer::~renderer() {
   m_sig.detach(this);
+
+  for (auto&& b : m_blocks) {
+    if (b.second.cache != nullptr) {
+      m_context->destroy(&b.second.cache);
+    }
+  }
+}
+
+/**
+ * Allocate the output window and the X resources used to draw it
+ */
+void renderer::setup_window() {
+  m_log.trace("renderer: Get TrueColor visual");
+  {
+    if ((m_visual = m_connection->visual_type(m_connection->screen(), 32)) == nullptr) {
+      m_log.err("No 32-bit TrueColor visual found...");
+
+      if ((m_visual = m_connection->visual_type(m_connection->screen(), 24)) == nullptr) {
+        m_log.err("No 24-bit TrueColor visual found...");
+      } else {
+        m_depth = 24;
+      }
+    }
+    if (m_visual == nullptr) {
+      throw application_error("No matching TrueColor");
+    }
+  }
+
+  m_log.trace("renderer: Allocate colormap");
+  {
+    m_colormap = m_connection->generate_id();
+    m_connection->create_colormap(
+        XCB_COLORMAP_ALLOC_NONE, m_colormap, m_connection->screen()->root, m_visual->visual_id);
+  }
+
+  m_log.trace("renderer: Allocate output window");
+  {
+    // clang-format off
+    m_window = winspec(*m_connection)
+      << cw_size(m_bar.size)
+      << cw_pos(m_bar.pos)
+      << cw_depth(m_depth)
+      << cw_visual(m_visual->visual_id)
+      << cw_class(XCB_WINDOW_CLASS_INPUT_OUTPUT)
+      << cw_params_back_pixel(0)
+      << cw_params_border_pixel(0)
+      << cw_params_backing_store(XCB_BACKING_STORE_WHEN_MAPPED)
+      << cw_params_colormap(m_colormap)
+      << cw_params_event_mask(XCB_EVENT_MASK_PROPERTY_CHANGE
+                             |XCB_EVENT_MASK_EXPOSURE
+                             |XCB_EVENT_MASK_BUTTON_PRESS)
+      << cw_params_override_redirect(m_bar.override_redirect)
+      << cw_flush(true);
+    // clang-format on
+  }
+
+  m_log.trace("renderer: Allocate window pixmaps");
+  {
+    m_pixmap = m_connection->generate_id();
+    m_connection->create_pixmap(m_depth, m_pixmap, m_window, m_bar.size.w, m_bar.size.h);
+  }
+
+  m_log.trace("renderer: Allocate graphic contexts");
+  {
+    unsigned int mask{0};
+    unsigned int value_list[32]{0};
+    xcb_params_gc_t params{};
+    XCB_AUX_ADD_PARAM(&mask, &params, foreground, m_bar.foreground);
+    XCB_AUX_ADD_PARAM(&mask, &params, graphics_exposures, 0);
+    connection::pack_values(mask, &params, value_list);
+    m_gcontext = m_connection->generate_id();
+    m_connection->create_gc(m_gcontext, m_pixmap, mask, value_list);
+  }
 }
 
 /**
@@ -192,27 +245,59 @@ const vector<action_block> renderer::actions() const {
   return m_actions;
 }
 
+/**
+ * Get the total time spent converting text to glyphs
+ */
+std::chrono::nanoseconds renderer::shaping_time() const {
+  return m_context->shaping_time();
+}
+
 /**
  * Begin render routine
  */
 void renderer::begin(xcb_rectangle_t rect) {
   m_log.trace_x("renderer: begin (geom=%ix%i+%i+%i)", rect.width, rect.height, rect.x, rect.y);
 
+  if (rect.x != m_rect.x || rect.y != m_rect.y || rect.width != m_rect.width || rect.height != m_rect.height) {
+    m_fulldamage = true;
+  }
+
+#ifdef DEBUG_HINTS
+  m_fulldamage = true;
+#endif
+
+#if WITH_XSHM
+  // The server may still be reading the previous frame
+  if (m_shm) {
+    m_shm->sync();
+  }
+#endif
+
   // Reset state
   m_rect = rect;
   m_actions.clear();
   m_attr.reset();
   m_align = alignment::NONE;
 
+  for (auto&& b : m_blocks) {
+    b.second.x = 0.0;
+    b.second.y = 0.0;
+    b.second.contents.clear();
+    b.second.reused = false;
+
+    // Cached patterns are drawn relative to the previous geometry
+    if (m_fulldamage && b.second.cache != nullptr) {
+      m_context->destroy(&b.second.cache);
+    }
+  }
+
   // Reset colors
   m_bg = 0;
   m_fg = m_bar.foreground;
   m_ul = m_bar.underline.color;
   m_ol = m_bar.overline.color;
 
-  // Clear canvas
   m_context->save();
-  m_context->clear();
 
   // Create corner mask
   if (m_bar.radius != 0.0 && m_cornermask == nullptr) {
@@ -231,8 +316,6 @@ void renderer::begin(xcb_rectangle_t rect) {
     m_context->restore();
   }
 
-  fill_borders();
-
   // clang-format off
   m_context->clip(cairo::rect{
       static_cast<double>(m_rect.x),
@@ -244,18 +327,46 @@ void renderer::begin(xcb_rectangle_t rect) {
 
 /**
  * End render routine
+ *
+ * Only the areas covered by blocks that changed their contents
+ * or geometry since the previous frame are repainted and copied
+ * to the window. The patterns of the blocks are kept so that
+ * unchanged blocks don't need to be drawn again in the next frame.
  */
 void renderer::end() {
   m_log.trace_x("renderer: end");
 
+  // Close the last block before the actions get their absolute position
+  finish_block();
+
   for (auto&& a : m_actions) {
     a.start_x += block_x(a.align) + m_rect.x;
     a.end_x += block_x(a.align) + m_rect.x;
   }
 
-  if (m_align != alignment::NONE) {
-    m_log.trace_x("renderer: pop(%i)", static_cast<int>(m_align));
-    m_context->pop(&m_blocks[m_align].pattern);
+  // Drop the clip region used while drawing the blocks
+  m_context->restore();
+
+  bool fulldamage{m_fulldamage};
+  auto damage = compute_damage();
+
+  if (fulldamage) {
+    m_context->clear();
+    fill_borders();
+  }
+
+  for (auto&& area : damage) {
+    m_log.trace_x("renderer: repaint(geom=%ix%i+%i+%i)", area.width, area.height, area.x, area.y);
+
+    m_context->save();
+    // clang-format off
+    m_context->clip(cairo::rect{
+        static_cast<double>(area.x),
+        static_cast<double>(area.y),
+        static_cast<double>(area.width),
+        static_cast<double>(area.height)});
+    // clang-format on
+    m_context->clear();
 
     // Capture the concatenated block contents
     // so that it can be masked with the corner pattern
@@ -281,18 +392,88 @@ void renderer::end() {
     }
 
     m_context->destroy(&blockcontents);
-  } else {
-    fill_background();
+    m_context->restore();
   }
 
-  m_context->restore();
-  m_surface->flush();
+  for (auto&& b : m_blocks) {
+    // Blocks that weren't drawn in this frame drop their cache
+    if (b.second.cache != nullptr) {
+      m_context->destroy(&b.second.cache);
+    }
+    b.second.cache = b.second.pattern;
+    b.second.pattern = nullptr;
+  }
 
-  flush();
+  if (fulldamage) {
+    flush();
+  } else {
+    flush(damage);
+  }
 
   m_sig.emit(signals::ui::changed{});
 }
 
+/**
+ * Collect the areas covered by blocks that changed since the
+ * previous frame, including the area they covered before
+ */
+vector<xcb_rectangle_t> renderer::compute_damage() {
+  vector<std::pair<int, int>> ranges;
+
+  for (auto&& b : m_blocks) {
+    auto& block = b.second;
+
+    if (b.first == alignment::NONE) {
+      // Contents drawn outside of an alignment block are not tracked
+      m_fulldamage = m_fulldamage || block.pattern != nullptr;
+      continue;
+    }
+
+    int x{static_cast<int>(block_x(b.first) + 0.5)};
+    int w{static_cast<int>(block_w(b.first) + 0.5)};
+
+    if (x != block.prev_x || w != block.prev_w || block.contents != block.prev_contents) {
+      if (block.prev_w > 0) {
+        ranges.emplace_back(block.prev_x, block.prev_x + block.prev_w);
+      }
+      if (w > 0) {
+        ranges.emplace_back(x, x + w);
+      }
+    }
+
+    block.prev_x = x;
+    block.prev_w = w;
+    std::swap(block.contents, block.prev_contents);
+  }
+
+  vector<xcb_rectangle_t> damage;
+
+  if (m_fulldamage) {
+    m_fulldamage = false;
+    damage.emplace_back(m_rect);
+    return damage;
+  }
+
+  std::sort(ranges.begin(), ranges.end());
+
+  for (auto&& range : ranges) {
+    int begin{math_util::cap<int>(range.first, 0, m_rect.width)};
+    int end{math_util::cap<int>(range.second, 0, m_rect.width)};
+
+    if (begin >= end) {
+      continue;
+    } else if (!damage.empty() && begin <= damage.back().x - m_rect.x + damage.back().width) {
+      int prev_end{damage.back().x - m_rect.x + damage.back().width};
+      damage.back().width = static_cast<uint16_t>(std::max(prev_end, end) - (damage.back().x - m_rect.x));
+    } else {
+      damage.emplace_back(xcb_rectangle_t{static_cast<int16_t>(m_rect.x + begin), m_rect.y,
+          static_cast<uint16_t>(end - begin), m_rect.height});
+    }
+  }
+
+  return damage;
+}
+
 /**
  * Flush contents of given alignment block
  */
@@ -337,7 +518,6 @@ void renderer::flush(alignment a) {
   }
 
   *m_context << cairo::abspos{0.0, 0.0};
-  m_context->destroy(&m_blocks[a].pattern);
   m_context->restore();
 }
 
@@ -345,7 +525,15 @@ void renderer::flush(alignment a) {
  * Flush pixmap contents onto the target window
  */
 void renderer::flush() {
-  m_log.trace_x("renderer: flush");
+  flush(vector<xcb_rectangle_t>{
+      xcb_rectangle_t{0, 0, static_cast<uint16_t>(m_bar.size.w), static_cast<uint16_t>(m_bar.size.h)}});
+}
+
+/**
+ * Flush given areas of the pixmap onto the target window
+ */
+void renderer::flush(const vector<xcb_rectangle_t>& areas) {
+  m_log.trace_x("renderer: flush (areas=%lu)", areas.size());
 
   highlight_clickable_areas();
 
@@ -354,23 +542,37 @@ void renderer::flush() {
   if (m_bar.shaded && m_bar.origin == edge::TOP) {
     m_log.trace_x(
         "renderer: copy pixmap (shaded=1, geom=%dx%d+%d+%d)", m_rect.width, m_rect.height, m_rect.x, m_rect.y);
-    auto geom = m_connection.get_geometry(m_window);
+    auto geom = m_connection->get_geometry(m_window);
     auto x1 = 0;
     auto y1 = m_rect.height - m_bar.shade_size.h - m_rect.y - geom->height;
     auto x2 = m_rect.x;
     auto y2 = m_rect.y;
     auto w = m_rect.width;
     auto h = m_rect.height - m_bar.shade_size.h + geom->height;
-    m_connection.copy_area(m_pixmap, m_window, m_gcontext, x1, y1, x2, y2, w, h);
-    m_connection.flush();
+    m_connection->copy_area(m_pixmap, m_window, m_gcontext, x1, y1, x2, y2, w, h);
+    m_connection->flush();
     return;
   }
 #endif
 #endif
 
   m_surface->flush();
-  m_connection.copy_area(m_pixmap, m_window, m_gcontext, 0, 0, 0, 0, m_bar.size.w, m_bar.size.h);
-  m_connection.flush();
+
+  // Offscreen frames only end up in snapshots
+  if (m_connection != nullptr) {
+    for (auto&& area : areas) {
+#if WITH_XSHM
+      if (m_shm) {
+        m_shm->put_image(m_window, m_gcontext, m_bar.size.w, m_bar.size.h, area, m_depth);
+        continue;
+      }
+#endif
+      m_connection->copy_area(
+          m_pixmap, m_window, m_gcontext, area.x, area.y, area.x, area.y, area.width, area.height);
+    }
+
+    m_connection->flush();
+  }
 
   if (!m_snapshot_dst.empty()) {
     try {
@@ -634,111 +836,283 @@ bool renderer::on(const signals::ui::request_snapshot& evt) {
   return true;
 }
 
-bool renderer::on(const signals::parser::change_background& evt) {
-  const unsigned int color{evt.cast()};
+/**
+ * Replay the draw commands of a frame
+ */
+void renderer::render(const display_list& commands) {
+  for (auto it = commands.begin(); it != commands.end(); ++it) {
+    const auto& cmd = *it;
+
+    if (cmd.type == drawtype::ALIGNMENT) {
+      auto next = std::find_if(
+          it + 1, commands.end(), [](const drawcmd& c) { return c.type == drawtype::ALIGNMENT; });
+
+      if (reuse_block(static_cast<alignment>(cmd.value), it + 1, next)) {
+        it = next - 1;
+        continue;
+      }
+    }
+
+    if (cmd.type != drawtype::ALIGNMENT && m_align != alignment::NONE) {
+      m_blocks[m_align].contents.emplace_back(cmd);
+    }
+
+    switch (cmd.type) {
+      case drawtype::ALIGNMENT:
+        change_alignment(static_cast<alignment>(cmd.value));
+        break;
+      case drawtype::BACKGROUND:
+        change_background(cmd.color);
+        break;
+      case drawtype::FOREGROUND:
+        change_foreground(cmd.color);
+        break;
+      case drawtype::UNDERLINE:
+        change_underline(cmd.color);
+        break;
+      case drawtype::OVERLINE:
+        change_overline(cmd.color);
+        break;
+      case drawtype::FONT:
+        change_font(cmd.value);
+        break;
+      case drawtype::OFFSET:
+        offset_pixel(cmd.value);
+        break;
+      case drawtype::ATTRIBUTE_SET:
+        attribute_set(static_cast<attribute>(cmd.value));
+        break;
+      case drawtype::ATTRIBUTE_UNSET:
+        attribute_unset(static_cast<attribute>(cmd.value));
+        break;
+      case drawtype::ATTRIBUTE_TOGGLE:
+        attribute_toggle(static_cast<attribute>(cmd.value));
+        break;
+      case drawtype::ACTION_BEGIN:
+        action_begin(static_cast<mousebtn>(cmd.value), cmd.data);
+        break;
+      case drawtype::ACTION_END:
+        action_end(static_cast<mousebtn>(cmd.value));
+        break;
+      case drawtype::TEXT:
+        draw_text(cmd.data);
+        break;
+      case drawtype::NONE:
+        break;
+    }
+  }
+}
+
+void renderer::change_background(unsigned int color) {
   if (color != m_bg) {
     m_log.trace_x("renderer: change_background(#%08x)", color);
     m_bg = color;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_foreground& evt) {
-  const unsigned int color{evt.cast()};
+void renderer::change_foreground(unsigned int color) {
   if (color != m_fg) {
     m_log.trace_x("renderer: change_foreground(#%08x)", color);
     m_fg = color;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_underline& evt) {
-  const unsigned int color{evt.cast()};
+void renderer::change_underline(unsigned int color) {
   if (color != m_ul) {
     m_log.trace_x("renderer: change_underline(#%08x)", color);
     m_ul = color;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_overline& evt) {
-  const unsigned int color{evt.cast()};
+void renderer::change_overline(unsigned int color) {
   if (color != m_ol) {
     m_log.trace_x("renderer: change_overline(#%08x)", color);
     m_ol = color;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_font& evt) {
-  const int font{evt.cast()};
+void renderer::change_font(int font) {
   if (font != m_font) {
     m_log.trace_x("renderer: change_font(%i)", font);
     m_font = font;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_alignment& evt) {
-  auto align = static_cast<const alignment&>(evt.cast());
+void renderer::change_alignment(alignment align) {
   if (align != m_align) {
     m_log.trace_x("renderer: change_alignment(%i)", static_cast<int>(align));
 
-    if (m_align != alignment::NONE) {
-      m_log.trace_x("renderer: pop(%i)", static_cast<int>(m_align));
-      m_context->pop(&m_blocks[m_align].pattern);
-    }
+    finish_block();
 
     m_align = align;
     m_blocks[m_align].x = 0.0;
     m_blocks[m_align].y = 0.0;
+    m_blocks[m_align].first_action = m_actions.size();
     m_context->push();
     m_log.trace_x("renderer: push(%i)", static_cast<int>(m_align));
 
+    record_state(m_blocks[m_align].contents);
     fill_background();
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::offset_pixel& evt) {
-  m_log.trace_x("renderer: offset_pixel(%f)", evt.cast());
-  m_blocks[m_align].x += evt.cast();
-  return true;
+/**
+ * Record the state inherited from the previous block, which
+ * has to be part of the contents when comparing blocks between frames
+ */
+void renderer::record_state(display_list& contents) const {
+  contents.emplace_back(drawcmd{drawtype::BACKGROUND, m_bg});
+  contents.emplace_back(drawcmd{drawtype::FOREGROUND, m_fg});
+  contents.emplace_back(drawcmd{drawtype::UNDERLINE, m_ul});
+  contents.emplace_back(drawcmd{drawtype::OVERLINE, m_ol});
+  contents.emplace_back(drawcmd{drawtype::FONT, 0U, m_font});
+  contents.emplace_back(drawcmd{drawtype::ATTRIBUTE_SET, 0U, static_cast<int>(m_attr.to_ulong())});
 }
 
-bool renderer::on(const signals::parser::attribute_set& evt) {
-  m_log.trace_x("renderer: attribute_set(%i)", static_cast<int>(evt.cast()));
-  m_attr.set(static_cast<int>(evt.cast()), true);
+/**
+ * Reuse the pattern drawn for the block in the previous frame
+ * if its contents are the same
+ */
+bool renderer::reuse_block(alignment align, display_list::const_iterator first, display_list::const_iterator last) {
+  if (align == alignment::NONE || align == m_align) {
+    return false;
+  }
+
+  auto& block = m_blocks[align];
+
+  // Blocks entered twice in the same frame are always drawn
+  if (block.cache == nullptr || !block.cacheable || !block.contents.empty()) {
+    return false;
+  }
+
+  display_list contents;
+  record_state(contents);
+  contents.insert(contents.end(), first, last);
+
+  if (contents != block.prev_contents) {
+    return false;
+  }
+
+  m_log.trace_x("renderer: reuse(%i)", static_cast<int>(align));
+
+  finish_block();
+
+  m_align = align;
+  block.reused = true;
+  block.contents = move(contents);
+  block.pattern = block.cache;
+  block.cache = nullptr;
+  block.x = block.cache_x;
+  block.y = block.cache_y;
+  m_actions.insert(m_actions.end(), block.cache_actions.begin(), block.cache_actions.end());
+
+  // Continue with the state the block was left in
+  for (auto&& cmd : block.cache_state) {
+    switch (cmd.type) {
+      case drawtype::BACKGROUND:
+        m_bg = cmd.color;
+        break;
+      case drawtype::FOREGROUND:
+        m_fg = cmd.color;
+        break;
+      case drawtype::UNDERLINE:
+        m_ul = cmd.color;
+        break;
+      case drawtype::OVERLINE:
+        m_ol = cmd.color;
+        break;
+      case drawtype::FONT:
+        m_font = cmd.value;
+        break;
+      case drawtype::ATTRIBUTE_SET:
+        m_attr = std::bitset<3>(static_cast<unsigned long>(cmd.value));
+        break;
+      default:
+        break;
+    }
+  }
+
   return true;
 }
 
-bool renderer::on(const signals::parser::attribute_unset& evt) {
-  m_log.trace_x("renderer: attribute_unset(%i)", static_cast<int>(evt.cast()));
-  m_attr.set(static_cast<int>(evt.cast()), false);
-  return true;
+/**
+ * Close the current block and remember its end state
+ * so that it can be reused in the next frame
+ */
+void renderer::finish_block() {
+  if (m_align == alignment::NONE) {
+    return;
+  }
+
+  auto& block = m_blocks[m_align];
+
+  if (block.reused) {
+    return;
+  }
+
+  m_log.trace_x("renderer: pop(%i)", static_cast<int>(m_align));
+  m_context->pop(&block.pattern);
+
+  block.cache_x = block.x;
+  block.cache_y = block.y;
+  block.cache_state.clear();
+  record_state(block.cache_state);
+  block.cache_actions.clear();
+
+  // Blocks with actions spanning other blocks can't be reused
+  int balance{0};
+  for (auto&& cmd : block.contents) {
+    if (cmd.type == drawtype::ACTION_BEGIN) {
+      balance++;
+    } else if (cmd.type == drawtype::ACTION_END) {
+      balance--;
+    }
+  }
+
+  block.cacheable = balance == 0;
+
+  for (size_t n = block.first_action; n < m_actions.size(); n++) {
+    if (m_actions[n].align != m_align) {
+      continue;
+    } else if (m_actions[n].active) {
+      block.cacheable = false;
+    }
+    block.cache_actions.emplace_back(m_actions[n]);
+  }
 }
 
-bool renderer::on(const signals::parser::attribute_toggle& evt) {
-  m_log.trace_x("renderer: attribute_toggle(%i)", static_cast<int>(evt.cast()));
-  m_attr.flip(static_cast<int>(evt.cast()));
-  return true;
+void renderer::offset_pixel(int px) {
+  m_log.trace_x("renderer: offset_pixel(%i)", px);
+  m_blocks[m_align].x += px;
+}
+
+void renderer::attribute_set(attribute attr) {
+  m_log.trace_x("renderer: attribute_set(%i)", static_cast<int>(attr));
+  m_attr.set(static_cast<int>(attr), true);
+}
+
+void renderer::attribute_unset(attribute attr) {
+  m_log.trace_x("renderer: attribute_unset(%i)", static_cast<int>(attr));
+  m_attr.set(static_cast<int>(attr), false);
 }
 
-bool renderer::on(const signals::parser::action_begin& evt) {
-  auto a = evt.cast();
-  m_log.trace_x("renderer: action_begin(btn=%i, command=%s)", static_cast<int>(a.button), a.command);
+void renderer::attribute_toggle(attribute attr) {
+  m_log.trace_x("renderer: attribute_toggle(%i)", static_cast<int>(attr));
+  m_attr.flip(static_cast<int>(attr));
+}
+
+void renderer::action_begin(mousebtn btn, const string& command) {
+  m_log.trace_x("renderer: action_begin(btn=%i, command=%s)", static_cast<int>(btn), command);
   action_block action{};
-  action.button = a.button == mousebtn::NONE ? mousebtn::LEFT : a.button;
+  action.button = btn == mousebtn::NONE ? mousebtn::LEFT : btn;
   action.align = m_align;
   action.start_x = m_blocks.at(m_align).x;
-  action.command = string_util::replace_all(a.command, ":", "\\:");
+  action.command = string_util::replace_all(command, ":", "\\:");
   action.active = true;
   m_actions.emplace_back(action);
-  return true;
 }
 
-bool renderer::on(const signals::parser::action_end& evt) {
-  auto btn = evt.cast();
+void renderer::action_end(mousebtn btn) {
   m_log.trace_x("renderer: action_end(btn=%i)", static_cast<int>(btn));
   for (auto action = m_actions.rbegin(); action != m_actions.rend(); action++) {
     if (action->active && action->align == m_align && action->button == btn) {
@@ -746,13 +1120,6 @@ bool renderer::on(const signals::parser::action_end& evt) {
       action->active = false;
     }
   }
-  return true;
-}
-
-bool renderer::on(const signals::parser::text& evt) {
-  auto text = evt.cast();
-  draw_text(text);
-  return true;
 }
 
 POLYBAR_NS_END
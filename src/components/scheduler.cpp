@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <limits>
+
+#include "components/logger.hpp"
+#include "components/scheduler.hpp"
+#include "errors.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+constexpr scheduler::duration scheduler::TICK;
+
+/**
+ * Create instance
+ *
+ * @param workers Size of the worker pool, only used by the first call
+ */
+scheduler::make_type scheduler::make(size_t workers) {
+  return static_cast<scheduler&>(*factory_util::singleton<scheduler>(logger::make(), workers));
+}
+
+/**
+ * Construct scheduler and start the worker threads
+ */
+scheduler::scheduler(const logger& logger, size_t workers) : m_log(logger) {
+  m_ticker = std::thread(&scheduler::tick_loop, this);
+  for (size_t i = 0; i < std::max(workers, size_t{1}); i++) {
+    m_workers.emplace_back(&scheduler::work, this);
+  }
+}
+
+/**
+ * Stop all threads, pending timers are discarded
+ */
+scheduler::~scheduler() {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_active = false;
+  }
+
+  m_tickcond.notify_all();
+  m_workcond.notify_all();
+
+  if (m_ticker.joinable()) {
+    m_ticker.join();
+  }
+  for (auto&& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+/**
+ * Register a timer, it doesn't run until it gets armed
+ */
+scheduler::timer_id scheduler::add(task fn) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto t = make_shared<timer>();
+  t->fn = move(fn);
+  m_timers.emplace(m_nextid, move(t));
+  return m_nextid++;
+}
+
+/**
+ * Run the timer once after given delay
+ *
+ * Replaces the expiry if the timer is already armed
+ */
+void scheduler::arm(timer_id id, duration delay) {
+  std::unique_lock<std::mutex> guard(m_lock);
+  auto it = m_timers.find(id);
+
+  if (it == m_timers.end()) {
+    return;
+  }
+
+  auto& t = *it->second;
+  t.generation++;
+  t.armed = true;
+
+  if (delay.count() <= 0) {
+    expire(slot_entry{id, t.generation, m_tick});
+  } else {
+    // Round up to the first tick that isn't earlier than the requested time
+    auto due = chrono::steady_clock::now() - m_epoch + delay;
+    auto tick = chrono::duration_cast<decltype(due)>(TICK).count();
+    insert(slot_entry{id, t.generation, static_cast<uint64_t>((due.count() + tick - 1) / tick)});
+    guard.unlock();
+    m_tickcond.notify_one();
+  }
+}
+
+/**
+ * Unregister the timer
+ *
+ * Blocks until a running invocation has finished, unless called from within it
+ */
+void scheduler::remove(timer_id id) {
+  std::unique_lock<std::mutex> guard(m_lock);
+  auto it = m_timers.find(id);
+
+  if (it == m_timers.end()) {
+    return;
+  }
+
+  auto t = it->second;
+  m_timers.erase(it);
+
+  if (t->running && t->runner != std::this_thread::get_id()) {
+    m_donecond.wait(guard, [&] { return !t->running; });
+  }
+}
+
+/**
+ * Get number of ticks elapsed since construction
+ */
+uint64_t scheduler::now_tick() const {
+  return chrono::duration_cast<duration>(chrono::steady_clock::now() - m_epoch).count() / TICK.count();
+}
+
+/**
+ * Place entry in the slot of the lowest level that covers its expiry
+ *
+ * Entries beyond the range of the wheel are placed in the last slot
+ * and get re-inserted once that slot is cascaded
+ */
+void scheduler::insert(const slot_entry& entry) {
+  uint64_t expires{std::max(entry.expires, m_tick)};
+  uint64_t delta{expires - m_tick};
+  size_t level{0};
+
+  while (level < LEVELS - 1 && delta >= uint64_t{1} << (LEVEL_BITS * (level + 1))) {
+    level++;
+  }
+  if (delta >= uint64_t{1} << (LEVEL_BITS * LEVELS)) {
+    expires = m_tick + (uint64_t{1} << (LEVEL_BITS * LEVELS)) - 1;
+  }
+
+  m_wheel[level][(expires >> (LEVEL_BITS * level)) & (SLOTS - 1)].emplace_back(entry);
+}
+
+/**
+ * Advance the wheel by one tick
+ *
+ * Cascades the slots of the higher levels that start at the new tick
+ * and expires the entries of the current slot of the lowest level
+ */
+void scheduler::advance() {
+  m_tick++;
+
+  for (size_t level = LEVELS - 1; level > 0; level--) {
+    if (m_tick & ((uint64_t{1} << (LEVEL_BITS * level)) - 1)) {
+      continue;
+    }
+
+    vector<slot_entry> entries;
+    entries.swap(m_wheel[level][(m_tick >> (LEVEL_BITS * level)) & (SLOTS - 1)]);
+
+    for (auto&& entry : entries) {
+      insert(entry);
+    }
+  }
+
+  vector<slot_entry> entries;
+  entries.swap(m_wheel[0][m_tick & (SLOTS - 1)]);
+
+  for (auto&& entry : entries) {
+    if (entry.expires > m_tick) {
+      insert(entry);
+    } else {
+      expire(entry);
+    }
+  }
+}
+
+/**
+ * Hand expired timer to the workers
+ *
+ * Entries of removed or re-armed timers are dropped
+ */
+void scheduler::expire(const slot_entry& entry) {
+  auto it = m_timers.find(entry.id);
+
+  if (it == m_timers.end() || it->second->generation != entry.generation || !it->second->armed) {
+    return;
+  }
+
+  auto& t = *it->second;
+  t.armed = false;
+
+  if (t.running) {
+    t.again = true;
+  } else if (std::find(m_ready.begin(), m_ready.end(), entry.id) == m_ready.end()) {
+    m_ready.emplace_back(entry.id);
+    m_workcond.notify_one();
+  }
+}
+
+/**
+ * Get the next tick at which a slot holding entries gets processed
+ */
+uint64_t scheduler::next_tick() const {
+  uint64_t next{std::numeric_limits<uint64_t>::max()};
+
+  for (size_t level = 0; level < LEVELS; level++) {
+    size_t shift{LEVEL_BITS * level};
+
+    for (uint64_t i = 1; i <= SLOTS; i++) {
+      uint64_t tick{((m_tick >> shift) + i) << shift};
+      if (!m_wheel[level][(tick >> shift) & (SLOTS - 1)].empty()) {
+        next = std::min(next, tick);
+        break;
+      }
+    }
+  }
+
+  return next;
+}
+
+/**
+ * Advance the wheel in real time
+ */
+void scheduler::tick_loop() {
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  while (m_active) {
+    uint64_t target{now_tick()};
+    uint64_t next;
+
+    // Skip the ticks that don't have anything to process
+    while ((next = next_tick()) <= target) {
+      m_tick = next - 1;
+      advance();
+    }
+    m_tick = std::max(m_tick, target);
+
+    if (next == std::numeric_limits<uint64_t>::max()) {
+      m_tickcond.wait(guard);
+    } else {
+      m_tickcond.wait_until(guard, m_epoch + TICK * static_cast<duration::rep>(next));
+    }
+  }
+}
+
+/**
+ * Run expired timers
+ */
+void scheduler::work() {
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  while (true) {
+    m_workcond.wait(guard, [&] { return !m_active || !m_ready.empty(); });
+
+    if (!m_active) {
+      break;
+    }
+
+    timer_id id{m_ready.front()};
+    m_ready.pop_front();
+
+    auto it = m_timers.find(id);
+    if (it == m_timers.end()) {
+      continue;
+    }
+
+    auto t = it->second;
+    t->running = true;
+    t->runner = std::this_thread::get_id();
+    guard.unlock();
+
+    try {
+      t->fn();
+    } catch (const exception& err) {
+      m_log.err("scheduler: Uncaught exception in timer (what: %s)", err.what());
+    }
+
+    guard.lock();
+    t->running = false;
+    t->runner = std::thread::id{};
+
+    if (t->again && m_timers.count(id)) {
+      t->again = false;
+      m_ready.emplace_back(id);
+      m_workcond.notify_one();
+    }
+
+    m_donecond.notify_all();
+  }
+}
+
+POLYBAR_NS_END
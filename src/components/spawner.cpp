@@ -0,0 +1,139 @@
+#include <sys/wait.h>
+#include <algorithm>
+#include <csignal>
+
+#include "components/logger.hpp"
+#include "components/spawner.hpp"
+#include "utils/command.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+/**
+ * Create instance
+ */
+spawner::make_type spawner::make(size_t limit) {
+  return factory_util::unique<spawner>(logger::make(), limit);
+}
+
+/**
+ * Construct spawner and start the worker threads
+ */
+spawner::spawner(const logger& logger, size_t limit) : m_log(logger) {
+  for (size_t i = 0; i < std::max(limit, size_t{1}); i++) {
+    m_workers.emplace_back(&spawner::work, this);
+  }
+}
+
+/**
+ * Terminate running commands and stop the workers
+ *
+ * Commands that haven't been started yet are discarded
+ */
+spawner::~spawner() {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_active = false;
+    m_jobs.clear();
+    for (auto&& pid : m_running) {
+      m_log.trace("spawner: Sending SIGTERM to running command (%d)", pid);
+      killpg(pid, SIGTERM);
+    }
+  }
+
+  m_cond.notify_all();
+
+  for (auto&& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+/**
+ * Queue command for execution
+ *
+ * @param cmd Shell command
+ * @param done Callback receiving the exit status
+ * @param key Commands sharing a non-empty key are run one at a time
+ */
+void spawner::spawn(string cmd, callback done, string key) {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_jobs.emplace_back(job{move(cmd), move(key), move(done)});
+  }
+  m_cond.notify_one();
+}
+
+/**
+ * Worker loop running the first command that isn't blocked by its key
+ */
+void spawner::work() {
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  while (true) {
+    auto next = m_jobs.end();
+
+    m_cond.wait(guard, [&] {
+      next = std::find_if(m_jobs.begin(), m_jobs.end(),
+          [&](const job& j) { return j.key.empty() || m_busy.find(j.key) == m_busy.end(); });
+      return !m_active || next != m_jobs.end();
+    });
+
+    if (!m_active) {
+      break;
+    }
+
+    job current{move(*next)};
+    m_jobs.erase(next);
+
+    if (!current.key.empty()) {
+      m_busy.emplace(current.key);
+    }
+
+    guard.unlock();
+
+    int status{EXIT_FAILURE};
+
+    try {
+      auto cmd = command_util::make_command(string{current.cmd});
+      cmd->exec(false);
+      pid_t pid{cmd->get_pid()};
+
+      guard.lock();
+      m_running.emplace(pid);
+      if (!m_active) {
+        killpg(pid, SIGTERM);
+      }
+      guard.unlock();
+
+      status = cmd->wait();
+
+      guard.lock();
+      m_running.erase(pid);
+      guard.unlock();
+
+      if (WIFEXITED(status)) {
+        status = WEXITSTATUS(status);
+      } else if (WIFSIGNALED(status)) {
+        status = 128 + WTERMSIG(status);
+      }
+    } catch (const exception& err) {
+      m_log.err("spawner: Failed to execute command (reason: %s)", err.what());
+    }
+
+    if (current.done) {
+      current.done(current.cmd, status);
+    }
+
+    guard.lock();
+
+    if (!current.key.empty()) {
+      m_busy.erase(current.key);
+      // Another worker might be waiting for this key
+      m_cond.notify_all();
+    }
+  }
+}
+
+POLYBAR_NS_END
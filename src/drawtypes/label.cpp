@@ -8,11 +8,18 @@ POLYBAR_NS
 
 namespace drawtypes {
   string label::get() const {
+    if (m_dirty) {
+      m_tokenized.clear();
+      for (auto&& segment : m_segments) {
+        m_tokenized += segment.replaced ? segment.value : segment.text;
+      }
+      m_dirty = false;
+    }
     return m_tokenized;
   }
 
   label::operator bool() {
-    return !m_tokenized.empty();
+    return !get().empty();
   }
 
   label_t label::clone() {
@@ -26,36 +33,53 @@ namespace drawtypes {
   }
 
   void label::clear() {
-    m_tokenized.clear();
+    reset_tokens(""s);
   }
 
   void label::reset_tokens() {
-    m_tokenized = m_text;
+    if (m_custom) {
+      compile(m_text);
+      m_custom = false;
+    } else {
+      for (auto&& segment : m_segments) {
+        segment.replaced = false;
+      }
+      m_dirty = true;
+    }
   }
 
   void label::reset_tokens(const string& tokenized) {
-    m_tokenized = tokenized;
+    compile(tokenized);
+    m_custom = true;
   }
 
   bool label::has_token(const string& token) const {
-    return m_tokenized.find(token) != string::npos;
+    return get().find(token) != string::npos;
   }
 
+  /**
+   * Fill the slots of the given token
+   *
+   * Slots keep the first replacement until the tokens are reset
+   */
   void label::replace_token(const string& token, string replacement) {
-    if (!has_token(token)) {
-      return;
-    }
+    for (auto&& segment : m_segments) {
+      if (segment.token == string::npos || segment.replaced || segment.text != token) {
+        continue;
+      }
 
-    for (auto&& tok : m_tokens) {
-      if (token == tok.token) {
-        if (tok.max != 0_z && replacement.length() > tok.max) {
-          replacement = replacement.erase(tok.max) + tok.suffix;
-        } else if (tok.min != 0_z && replacement.length() < tok.min) {
-          replacement.insert(0_z, tok.min - replacement.length(), ' ');
-        }
-        m_tokenized = string_util::replace_all(m_tokenized, token, move(replacement));
-        m_tokenized = string_util::replace_all(m_tokenized, token, move(replacement));
+      auto& tok = m_tokens[segment.token];
+      segment.value = replacement;
+
+      if (tok.max != 0_z && segment.value.length() > tok.max) {
+        segment.value.erase(tok.max);
+        segment.value += tok.suffix;
+      } else if (tok.min != 0_z && segment.value.length() < tok.min) {
+        segment.value.insert(0_z, tok.min - segment.value.length(), ' ');
       }
+
+      segment.replaced = true;
+      m_dirty = true;
     }
   }
 
@@ -127,6 +151,41 @@ namespace drawtypes {
     }
   }
 
+  /**
+   * Split the text into literal segments and token slots
+   */
+  void label::compile(const string& text) {
+    m_segments.clear();
+    m_dirty = true;
+
+    size_t pos{0_z};
+    while (pos < text.size()) {
+      size_t start{string::npos};
+      size_t index{string::npos};
+
+      for (size_t i = 0; i < m_tokens.size(); i++) {
+        auto found = text.find(m_tokens[i].token, pos);
+        if (found < start) {
+          start = found;
+          index = i;
+        }
+      }
+
+      if (index == string::npos) {
+        break;
+      } else if (start > pos) {
+        m_segments.push_back({text.substr(pos, start - pos), string::npos});
+      }
+
+      m_segments.push_back({m_tokens[index].token, index});
+      pos = start + m_tokens[index].token.size();
+    }
+
+    if (pos < text.size()) {
+      m_segments.push_back({text.substr(pos), string::npos});
+    }
+  }
+
   /**
    * Create a label by loading values from the configuration
    */
@@ -41,27 +41,36 @@ namespace drawtypes {
     }
   }
 
-  string progressbar::output(float percentage) {
-    string output{m_format};
-
+  display_list progressbar::output(float percentage) {
     // Get fill/empty widths based on percentage
     unsigned int perc = math_util::cap(percentage, 0.0f, 100.0f);
     unsigned int fill_width = math_util::percentage_to_value(perc, m_width);
     unsigned int empty_width = m_width - fill_width;
 
-    // Output fill icons
-    fill(perc, fill_width);
-    output = string_util::replace_all(output, "%fill%", m_builder->flush());
-
-    // Output indicator icon
-    m_builder->node(m_indicator);
-    output = string_util::replace_all(output, "%indicator%", m_builder->flush());
+    size_t pos{0};
+    size_t literal{0};
+
+    while ((pos = m_format.find('%', pos)) != string::npos) {
+      if (m_format.compare(pos, 6, "%fill%") == 0) {
+        m_builder->append(m_format.substr(literal, pos - literal));
+        fill(perc, fill_width);
+        literal = pos += 6;
+      } else if (m_format.compare(pos, 11, "%indicator%") == 0) {
+        m_builder->append(m_format.substr(literal, pos - literal));
+        m_builder->node(m_indicator);
+        literal = pos += 11;
+      } else if (m_format.compare(pos, 7, "%empty%") == 0) {
+        m_builder->append(m_format.substr(literal, pos - literal));
+        m_builder->node_repeat(m_empty, empty_width);
+        literal = pos += 7;
+      } else {
+        pos++;
+      }
+    }
 
-    // Output empty icons
-    m_builder->node_repeat(m_empty, empty_width);
-    output = string_util::replace_all(output, "%empty%", m_builder->flush());
+    m_builder->append(m_format.substr(literal));
 
-    return output;
+    return m_builder->flush();
   }
 
   void progressbar::fill(unsigned int perc, unsigned int fill_width) {
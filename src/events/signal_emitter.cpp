@@ -3,8 +3,6 @@
 
 POLYBAR_NS
 
-signal_receivers_t g_signal_receivers;
-
 /**
  * Create instance
  */
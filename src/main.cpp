@@ -4,6 +4,7 @@
 #include "components/controller.hpp"
 #include "components/ipc.hpp"
 #include "components/parser.hpp"
+#include "components/reaper.hpp"
 #include "components/renderer.hpp"
 #include "utils/env.hpp"
 #include "utils/inotify.hpp"
@@ -25,7 +26,9 @@ int main(int argc, char** argv) {
       command_line::option{"-m", "--list-monitors", "Print list of available monitors and exit"},
       command_line::option{"-w", "--print-wmname", "Print the generated WM_NAME and exit"},
       command_line::option{"-s", "--stdout", "Output data to stdout instead of drawing it to the X window"},
-      command_line::option{"-p", "--png", "Save png snapshot to FILE after running for 3 seconds", "FILE"},
+      command_line::option{"-p", "--png", "Save png snapshot to FILE once all modules have produced output", "FILE"},
+      command_line::option{"-R", "--record", "Write the contents of each drawn frame to FILE", "FILE"},
+      command_line::option{"-o", "--offscreen", "Render without an X server and exit after the snapshot (requires --png)"},
   };
   // clang-format on
 
@@ -35,6 +38,9 @@ int main(int argc, char** argv) {
   logger& logger{const_cast<decltype(logger)>(logger::make(loglevel::WARNING))};
 
   try {
+    // Set up child process collection before any thread is started
+    reaper::make();
+
     //==================================================
     // Parse command line arguments
     //==================================================
@@ -58,34 +64,44 @@ int main(int argc, char** argv) {
       return EXIT_SUCCESS;
     }
 
-    //==================================================
-    // Connect to X server
-    //==================================================
-    auto xcb_error = 0;
-    auto xcb_screen = 0;
-    auto xcb_connection = xcb_connect(nullptr, &xcb_screen);
-
-    if (xcb_connection == nullptr) {
-      throw application_error("A connection to X could not be established...");
-    } else if ((xcb_error = xcb_connection_has_error(xcb_connection))) {
-      throw application_error("X connection error... (what: " + connection::error_str(xcb_error) + ")");
-    }
+    bool headless{cli->has("offscreen")};
 
-    connection& conn{connection::make(xcb_connection, xcb_screen)};
-    conn.ensure_event_mask(conn.root(), XCB_EVENT_MASK_PROPERTY_CHANGE);
+    if (headless && !cli->has("png")) {
+      throw application_error("Rendering offscreen requires a snapshot destination, use --png=FILE");
+    } else if (headless && (cli->has("list-monitors") || cli->has("print-wmname") || cli->has("stdout"))) {
+      throw application_error("Option not available when rendering offscreen");
+    }
 
     //==================================================
-    // List available XRandR entries
+    // Connect to X server
     //==================================================
-    if (cli->has("list-monitors")) {
-      for (auto&& mon : randr_util::get_monitors(conn, conn.root(), true)) {
-        if (WITH_XRANDR_MONITORS && mon->output == XCB_NONE) {
-          printf("%s: %ix%i+%i+%i (XRandR monitor)\n", mon->name.c_str(), mon->w, mon->h, mon->x, mon->y);
-        } else {
-          printf("%s: %ix%i+%i+%i\n", mon->name.c_str(), mon->w, mon->h, mon->x, mon->y);
+    if (!headless) {
+      auto xcb_error = 0;
+      auto xcb_screen = 0;
+      auto xcb_connection = xcb_connect(nullptr, &xcb_screen);
+
+      if (xcb_connection == nullptr) {
+        throw application_error("A connection to X could not be established...");
+      } else if ((xcb_error = xcb_connection_has_error(xcb_connection))) {
+        throw application_error("X connection error... (what: " + connection::error_str(xcb_error) + ")");
+      }
+
+      connection& conn{connection::make(xcb_connection, xcb_screen)};
+      conn.ensure_event_mask(conn.root(), XCB_EVENT_MASK_PROPERTY_CHANGE);
+
+      //==================================================
+      // List available XRandR entries
+      //==================================================
+      if (cli->has("list-monitors")) {
+        for (auto&& mon : randr_util::get_monitors(conn, conn.root(), true)) {
+          if (WITH_XRANDR_MONITORS && mon->output == XCB_NONE) {
+            printf("%s: %ix%i+%i+%i (XRandR monitor)\n", mon->name.c_str(), mon->w, mon->h, mon->x, mon->y);
+          } else {
+            printf("%s: %ix%i+%i+%i\n", mon->name.c_str(), mon->w, mon->h, mon->x, mon->y);
+          }
         }
+        return EXIT_SUCCESS;
       }
-      return EXIT_SUCCESS;
     }
 
     //==================================================
@@ -97,10 +113,17 @@ int main(int argc, char** argv) {
     if (!cli->has(0)) {
       cli->usage();
       return EXIT_FAILURE;
-    } else if (cli->has(1)) {
-      fprintf(stderr, "Unrecognized argument \"%s\"\n", cli->get(1).c_str());
-      cli->usage();
-      return EXIT_FAILURE;
+    }
+
+    // Any additional bar is hosted by the same process
+    vector<string> extra_bars;
+    for (size_t i = 1; cli->has(i); i++) {
+      extra_bars.emplace_back(cli->get(i));
+    }
+
+    if (!extra_bars.empty() && (cli->has("stdout") || cli->has("png") || cli->has("record") ||
+                                   cli->has("print-wmname") || cli->has("dump"))) {
+      throw application_error("Option only available when running a single bar");
     }
 
     if (cli->has("config")) {
@@ -140,9 +163,9 @@ int main(int argc, char** argv) {
       config_watch = inotify_util::make_watch(conf.filepath());
     }
 
-    auto ctrl = controller::make(move(ipc), move(config_watch));
+    auto ctrl = controller::make(move(ipc), move(config_watch), headless, extra_bars);
 
-    if (!ctrl->run(cli->has("stdout"), cli->get("png"))) {
+    if (!ctrl->run(cli->has("stdout"), cli->get("png"), cli->get("record"))) {
       reload = true;
     }
   } catch (const exception& err) {
@@ -150,10 +173,7 @@ int main(int argc, char** argv) {
     exit_code = EXIT_FAILURE;
   }
 
-  logger.info("Waiting for spawned processes to end");
-  while (process_util::notify_childprocess()) {
-    ;
-  }
+  reaper::make().wait_all();
 
   if (reload) {
     logger.info("Re-launching application...");
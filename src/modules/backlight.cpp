@@ -28,7 +28,7 @@ namespace modules {
     auto card = m_conf.get(name(), "card");
 
     // Add formats and elements
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR, TAG_RAMP});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {{TAG_LABEL, tag::LABEL}, {TAG_BAR, tag::BAR}, {TAG_RAMP, tag::RAMP}});
 
     if (m_formatter->has(TAG_LABEL)) {
       m_label = load_optional_label(m_conf, name(), TAG_LABEL, "%percentage%%");
@@ -46,10 +46,7 @@ namespace modules {
 
     // Add inotify watch
     watch(string_util::replace(PATH_BACKLIGHT_VAL, "%card%", card));
-  }
-
-  void backlight_module::idle() {
-    sleep(75ms);
+    m_cooldown = 75ms;
   }
 
   bool backlight_module::on_event(inotify_event* event) {
@@ -67,15 +64,19 @@ namespace modules {
     return true;
   }
 
-  bool backlight_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_BAR) {
-      builder->node(m_progressbar->output(m_percentage));
-    } else if (tag == TAG_RAMP) {
-      builder->node(m_ramp->get_by_percentage(m_percentage));
-    } else if (tag == TAG_LABEL) {
-      builder->node(m_label);
-    } else {
-      return false;
+  bool backlight_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::BAR:
+        builder->append(m_progressbar->output(m_percentage));
+        break;
+      case tag::RAMP:
+        builder->node(m_ramp->get_by_percentage(m_percentage));
+        break;
+      case tag::LABEL:
+        builder->node(m_label);
+        break;
+      default:
+        return false;
     }
     return true;
   }
@@ -27,7 +27,7 @@ namespace modules {
     // Load configuration values
     m_fullat = math_util::min(m_conf.get(name(), "full-at", m_fullat), 100);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "poll-interval", 5s);
-    m_lastpoll = chrono::system_clock::now();
+    m_timeout = chrono::duration_cast<scheduler::duration>(m_interval);
 
     auto path_adapter = string_util::replace(PATH_ADAPTER, "%adapter%", m_conf.get(name(), "adapter", "ADP1"s)) + "/";
     auto path_battery = string_util::replace(PATH_BATTERY, "%battery%", m_conf.get(name(), "battery", "BAT0"s)) + "/";
@@ -87,10 +87,14 @@ namespace modules {
 
     // Add formats and elements
     m_formatter->add(FORMAT_CHARGING, TAG_LABEL_CHARGING,
-        {TAG_BAR_CAPACITY, TAG_RAMP_CAPACITY, TAG_ANIMATION_CHARGING, TAG_LABEL_CHARGING});
-    m_formatter->add(
-        FORMAT_DISCHARGING, TAG_LABEL_DISCHARGING, {TAG_BAR_CAPACITY, TAG_RAMP_CAPACITY, TAG_LABEL_DISCHARGING});
-    m_formatter->add(FORMAT_FULL, TAG_LABEL_FULL, {TAG_BAR_CAPACITY, TAG_RAMP_CAPACITY, TAG_LABEL_FULL});
+        {{TAG_BAR_CAPACITY, tag::BAR_CAPACITY}, {TAG_RAMP_CAPACITY, tag::RAMP_CAPACITY},
+            {TAG_ANIMATION_CHARGING, tag::ANIMATION_CHARGING}, {TAG_LABEL_CHARGING, tag::LABEL_CHARGING}});
+    m_formatter->add(FORMAT_DISCHARGING, TAG_LABEL_DISCHARGING,
+        {{TAG_BAR_CAPACITY, tag::BAR_CAPACITY}, {TAG_RAMP_CAPACITY, tag::RAMP_CAPACITY},
+            {TAG_LABEL_DISCHARGING, tag::LABEL_DISCHARGING}});
+    m_formatter->add(FORMAT_FULL, TAG_LABEL_FULL,
+        {{TAG_BAR_CAPACITY, tag::BAR_CAPACITY}, {TAG_RAMP_CAPACITY, tag::RAMP_CAPACITY},
+            {TAG_LABEL_FULL, tag::LABEL_FULL}});
 
     if (m_formatter->has(TAG_ANIMATION_CHARGING, FORMAT_CHARGING)) {
       m_animation_charging = load_animation(m_conf, name(), TAG_ANIMATION_CHARGING);
@@ -126,43 +130,44 @@ namespace modules {
   }
 
   /**
-   * Dispatch the subthread used to update the
+   * Schedule the timer used to update the
    * charging animation when the module is started
    */
   void battery_module::start() {
     this->inotify_module::start();
-    m_subthread = thread(&battery_module::subthread, this);
+    m_animation_timer = scheduler::make().add([this] { animate(); });
+    scheduler::make().arm(m_animation_timer, 0ms);
   }
 
   /**
-   * Release wake lock when stopping the module
+   * Stop the animation timer when stopping the module
+   *
+   * The timer is removed before the module locks are taken
+   * since a running animation frame needs them to finish
    */
-  void battery_module::teardown() {
-    if (m_subthread.joinable()) {
-      m_subthread.join();
+  void battery_module::stop() {
+    if (m_animation_timer) {
+      scheduler::make().remove(m_animation_timer);
     }
+    this->inotify_module::stop();
   }
 
   /**
-   * Idle between polling inotify watches for events.
-   *
-   * If the defined interval has been reached, trigger a manual
-   * poll in case the inotify events aren't fired.
+   * Poll the values when no inotify event has been reported
+   * within the defined interval.
    *
    * This fallback is needed because some systems won't
    * report inotify events for files on sysfs.
    */
-  void battery_module::idle() {
-    if (m_interval.count() > 0) {
-      auto now = chrono::system_clock::now();
-      if (chrono::duration_cast<decltype(m_interval)>(now - m_lastpoll) > m_interval) {
-        m_lastpoll = now;
-        m_log.info("%s: Polling values (inotify fallback)", name());
-        read(*m_capacity_reader);
-      }
+  bool battery_module::on_timeout() {
+    m_log.info("%s: Polling values (inotify fallback)", name());
+
+    auto state = current_state();
+    if (state == m_state && current_percentage(state) == m_percentage) {
+      return false;
     }
 
-    this->inotify_module::idle();
+    return on_event(nullptr);
   }
 
   /**
@@ -172,9 +177,6 @@ namespace modules {
     auto state = current_state();
     auto percentage = current_percentage(state);
 
-    // Reset timer to avoid unnecessary polling
-    m_lastpoll = chrono::system_clock::now();
-
     if (event != nullptr) {
       m_log.trace("%s: Inotify event reported for %s", name(), event->filename);
 
@@ -226,21 +228,28 @@ namespace modules {
   /**
    * Generate module output using defined drawtypes
    */
-  bool battery_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_ANIMATION_CHARGING) {
-      builder->node(m_animation_charging->get());
-    } else if (tag == TAG_BAR_CAPACITY) {
-      builder->node(m_bar_capacity->output(m_percentage));
-    } else if (tag == TAG_RAMP_CAPACITY) {
-      builder->node(m_ramp_capacity->get_by_percentage(m_percentage));
-    } else if (tag == TAG_LABEL_CHARGING) {
-      builder->node(m_label_charging);
-    } else if (tag == TAG_LABEL_DISCHARGING) {
-      builder->node(m_label_discharging);
-    } else if (tag == TAG_LABEL_FULL) {
-      builder->node(m_label_full);
-    } else {
-      return false;
+  bool battery_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::ANIMATION_CHARGING:
+        builder->node(m_animation_charging->get());
+        break;
+      case tag::BAR_CAPACITY:
+        builder->append(m_bar_capacity->output(m_percentage));
+        break;
+      case tag::RAMP_CAPACITY:
+        builder->node(m_ramp_capacity->get_by_percentage(m_percentage));
+        break;
+      case tag::LABEL_CHARGING:
+        builder->node(m_label_charging);
+        break;
+      case tag::LABEL_DISCHARGING:
+        builder->node(m_label_discharging);
+        break;
+      case tag::LABEL_FULL:
+        builder->node(m_label_full);
+        break;
+      default:
+        return false;
     }
 
     return true;
@@ -293,28 +302,22 @@ namespace modules {
   }
 
   /**
-   * Subthread runner that emit update events
+   * Timer callback that emit update events
    * to refresh <animation-charging> in case it is used.
    */
-  void battery_module::subthread() {
-    chrono::duration<double> dur{0.0};
-
-    if (m_animation_charging) {
-      dur += chrono::milliseconds{m_animation_charging->framerate()};
-    } else {
-      dur += 1s;
+  void battery_module::animate() {
+    if (!running()) {
+      return;
     }
-
-    while (running()) {
-      for (int i = 0; running() && i < dur.count(); ++i) {
-        if (m_state == battery_module::state::CHARGING) {
-          broadcast();
-        }
-        sleep(dur);
-      }
+    if (m_state == battery_module::state::CHARGING) {
+      broadcast();
     }
 
-    m_log.trace("%s: End of subthread", name());
+    chrono::milliseconds dur{1s};
+    if (m_animation_charging) {
+      dur = chrono::milliseconds{m_animation_charging->framerate()};
+    }
+    scheduler::make().arm(m_animation_timer, dur);
   }
 }
 
@@ -59,7 +59,8 @@ namespace modules {
     m_fuzzy_match = m_conf.get(name(), "fuzzy-match", m_fuzzy_match);
 
     // Add formats and create components
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL_STATE, {TAG_LABEL_STATE}, {TAG_LABEL_MONITOR, TAG_LABEL_MODE});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL_STATE, {{TAG_LABEL_STATE, tag::LABEL_STATE}},
+        {{TAG_LABEL_MONITOR, tag::LABEL_MONITOR}, {TAG_LABEL_MODE, tag::LABEL_MODE}});
 
     if (m_formatter->has(TAG_LABEL_MONITOR)) {
       m_monitorlabel = load_optional_label(m_conf, name(), "label-monitor", DEFAULT_MONITOR_LABEL);
@@ -143,6 +144,13 @@ namespace modules {
     event_module::stop();
   }
 
+  vector<struct pollfd> bspwm_module::poll_descriptors() {
+    if (!m_subscriber) {
+      return {};
+    }
+    return {{m_subscriber->get_file_descriptor(), POLLIN, 0}};
+  }
+
   bool bspwm_module::has_event() {
     if (m_subscriber->poll(POLLHUP, 0)) {
       m_log.warn("%s: Reconnecting to socket...", name());
@@ -367,68 +375,82 @@ namespace modules {
     return true;
   }
 
-  string bspwm_module::get_output() {
-    string output;
+  display_list bspwm_module::get_output() {
+    display_list output;
     for (m_index = 0U; m_index < m_monitors.size(); m_index++) {
       if (m_index > 0) {
         m_builder->space(m_formatter->get(DEFAULT_FORMAT)->spacing);
       }
-      output += this->event_module::get_output();
+      auto monitor = this->event_module::get_output();
+      output.insert(output.end(), monitor.begin(), monitor.end());
     }
     return output;
   }
 
-  bool bspwm_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL_MONITOR) {
-      builder->node(m_monitors[m_index]->label);
-      return true;
-    } else if (tag == TAG_LABEL_STATE && !m_monitors[m_index]->workspaces.empty()) {
-      size_t workspace_n{0U};
+  bool bspwm_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL_MONITOR:
+        builder->node(m_monitors[m_index]->label);
+        return true;
 
-      if (m_scroll) {
-        builder->cmd(mousebtn::SCROLL_DOWN, EVENT_SCROLL_DOWN);
-        builder->cmd(mousebtn::SCROLL_UP, EVENT_SCROLL_UP);
-      }
+      case tag::LABEL_STATE: {
+        if (m_monitors[m_index]->workspaces.empty()) {
+          return false;
+        }
 
-      for (auto&& ws : m_monitors[m_index]->workspaces) {
-        if (ws.second.get()) {
-          workspace_n++;
+        size_t workspace_n{0U};
 
-          if (m_click) {
-            builder->cmd(mousebtn::LEFT, sstream() << EVENT_CLICK << m_index << "+" << workspace_n, ws.second);
-          } else {
-            builder->node(ws.second);
-          }
+        if (m_scroll) {
+          builder->cmd(mousebtn::SCROLL_DOWN, EVENT_SCROLL_DOWN);
+          builder->cmd(mousebtn::SCROLL_UP, EVENT_SCROLL_UP);
+        }
+
+        for (auto&& ws : m_monitors[m_index]->workspaces) {
+          if (ws.second.get()) {
+            workspace_n++;
 
-          if (m_inlinemode && m_monitors[m_index]->focused && check_mask(ws.first, bspwm_state::FOCUSED)) {
-            for (auto&& mode : m_monitors[m_index]->modes) {
-              builder->node(mode);
+            if (m_click) {
+              builder->cmd(mousebtn::LEFT, sstream() << EVENT_CLICK << m_index << "+" << workspace_n, ws.second);
+            } else {
+              builder->node(ws.second);
+            }
+
+            if (m_inlinemode && m_monitors[m_index]->focused && check_mask(ws.first, bspwm_state::FOCUSED)) {
+              for (auto&& mode : m_monitors[m_index]->modes) {
+                builder->node(mode);
+              }
             }
           }
         }
-      }
 
-      if (m_scroll) {
-        builder->cmd_close();
-        builder->cmd_close();
+        if (m_scroll) {
+          builder->cmd_close();
+          builder->cmd_close();
+        }
+
+        return workspace_n > 0;
       }
 
-      return workspace_n > 0;
-    } else if (tag == TAG_LABEL_MODE && !m_inlinemode && m_monitors[m_index]->focused &&
-               !m_monitors[m_index]->modes.empty()) {
-      int modes_n = 0;
+      case tag::LABEL_MODE: {
+        if (m_inlinemode || !m_monitors[m_index]->focused || m_monitors[m_index]->modes.empty()) {
+          return false;
+        }
+
+        int modes_n = 0;
 
-      for (auto&& mode : m_monitors[m_index]->modes) {
-        if (mode && *mode) {
-          builder->node(mode);
-          modes_n++;
+        for (auto&& mode : m_monitors[m_index]->modes) {
+          if (mode && *mode) {
+            builder->node(mode);
+            modes_n++;
+          }
         }
+
+        return modes_n > 0;
       }
 
-      return modes_n > 0;
+      default:
+        return false;
     }
-
-    return false;
   }
 
   bool bspwm_module::input(string&& cmd) {
@@ -10,7 +10,7 @@ namespace modules {
   counter_module::counter_module(const bar_settings& bar, string name_)
       : timer_module<counter_module>(bar, move(name_)) {
     m_interval = m_conf.get(name(), "interval", m_interval);
-    m_formatter->add(DEFAULT_FORMAT, TAG_COUNTER, {TAG_COUNTER});
+    m_formatter->add(DEFAULT_FORMAT, TAG_COUNTER, {{TAG_COUNTER, tag::COUNTER}});
   }
 
   bool counter_module::update() {
@@ -18,8 +18,8 @@ namespace modules {
     return true;
   }
 
-  bool counter_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_COUNTER) {
+  bool counter_module::build(builder* builder, int id) const {
+    if (static_cast<tag>(id) == tag::COUNTER) {
       builder->node(to_string(m_counter));
       return true;
     }
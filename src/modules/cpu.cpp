@@ -18,7 +18,9 @@ namespace modules {
   cpu_module::cpu_module(const bar_settings& bar, string name_) : timer_module<cpu_module>(bar, move(name_)) {
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 1s);
 
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_LOAD, TAG_RAMP_LOAD, TAG_RAMP_LOAD_PER_CORE});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL,
+        {{TAG_LABEL, tag::LABEL}, {TAG_BAR_LOAD, tag::BAR_LOAD}, {TAG_RAMP_LOAD, tag::RAMP_LOAD},
+            {TAG_RAMP_LOAD_PER_CORE, tag::RAMP_LOAD_PER_CORE}});
 
     // warmup cpu times
     read_values();
@@ -86,24 +88,30 @@ namespace modules {
     return true;
   }
 
-  bool cpu_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL) {
-      builder->node(m_label);
-    } else if (tag == TAG_BAR_LOAD) {
-      builder->node(m_barload->output(m_total));
-    } else if (tag == TAG_RAMP_LOAD) {
-      builder->node(m_rampload->get_by_percentage(m_total));
-    } else if (tag == TAG_RAMP_LOAD_PER_CORE) {
-      auto i = 0;
-      for (auto&& load : m_load) {
-        if (i++ > 0) {
-          builder->space(1);
+  bool cpu_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL:
+        builder->node(m_label);
+        break;
+      case tag::BAR_LOAD:
+        builder->append(m_barload->output(m_total));
+        break;
+      case tag::RAMP_LOAD:
+        builder->node(m_rampload->get_by_percentage(m_total));
+        break;
+      case tag::RAMP_LOAD_PER_CORE: {
+        auto i = 0;
+        for (auto&& load : m_load) {
+          if (i++ > 0) {
+            builder->space(1);
+          }
+          builder->node(m_rampload_core->get_by_percentage(load));
         }
-        builder->node(m_rampload_core->get_by_percentage(load));
+        builder->append(builder->flush());
+        break;
       }
-      builder->node(builder->flush());
-    } else {
-      return false;
+      default:
+        return false;
     }
     return true;
   }
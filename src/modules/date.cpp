@@ -24,13 +24,14 @@ namespace modules {
 
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 1s);
 
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_DATE});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {{TAG_LABEL, tag::LABEL}, {TAG_DATE, tag::DATE}});
 
     if (m_formatter->has(TAG_DATE)) {
       m_log.warn("%s: The format tag `<date>` is deprecated, use `<label>` instead.", name());
 
       m_formatter->get(DEFAULT_FORMAT)->value =
           string_util::replace_all(m_formatter->get(DEFAULT_FORMAT)->value, TAG_DATE, TAG_LABEL);
+      m_formatter->get(DEFAULT_FORMAT)->compile();
     }
 
     if (m_formatter->has(TAG_LABEL)) {
@@ -68,17 +69,15 @@ namespace modules {
     return true;
   }
 
-  bool date_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL) {
-      if (!m_dateformat_alt.empty() || !m_timeformat_alt.empty()) {
-        builder->cmd(mousebtn::LEFT, EVENT_TOGGLE);
-        builder->node(m_label);
-        builder->cmd_close();
-      } else {
-        builder->node(m_label);
-      }
-    } else {
+  bool date_module::build(builder* builder, int id) const {
+    if (static_cast<tag>(id) != tag::LABEL) {
       return false;
+    } else if (!m_dateformat_alt.empty() || !m_timeformat_alt.empty()) {
+      builder->cmd(mousebtn::LEFT, EVENT_TOGGLE);
+      builder->node(m_label);
+      builder->cmd_close();
+    } else {
+      builder->node(m_label);
     }
 
     return true;
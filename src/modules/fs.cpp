@@ -33,9 +33,10 @@ namespace modules {
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 30s);
 
     // Add formats and elements
-    m_formatter->add(
-        FORMAT_MOUNTED, TAG_LABEL_MOUNTED, {TAG_LABEL_MOUNTED, TAG_BAR_FREE, TAG_BAR_USED, TAG_RAMP_CAPACITY});
-    m_formatter->add(FORMAT_UNMOUNTED, TAG_LABEL_UNMOUNTED, {TAG_LABEL_UNMOUNTED});
+    m_formatter->add(FORMAT_MOUNTED, TAG_LABEL_MOUNTED,
+        {{TAG_LABEL_MOUNTED, tag::LABEL_MOUNTED}, {TAG_BAR_FREE, tag::BAR_FREE}, {TAG_BAR_USED, tag::BAR_USED},
+            {TAG_RAMP_CAPACITY, tag::RAMP_CAPACITY}});
+    m_formatter->add(FORMAT_UNMOUNTED, TAG_LABEL_UNMOUNTED, {{TAG_LABEL_UNMOUNTED, tag::LABEL_UNMOUNTED}});
 
     if (m_formatter->has(TAG_LABEL_MOUNTED)) {
       m_labelmounted = load_optional_label(m_conf, name(), TAG_LABEL_MOUNTED, "%mountpoint% %percentage_free%%");
@@ -123,14 +124,15 @@ namespace modules {
   /**
    * Generate the module output
    */
-  string fs_module::get_output() {
-    string output;
+  display_list fs_module::get_output() {
+    display_list output;
 
     for (m_index = 0_z; m_index < m_mounts.size(); ++m_index) {
       if (!output.empty()) {
         m_builder->space(m_spacing);
       }
-      output += timer_module::get_output();
+      auto mount = timer_module::get_output();
+      output.insert(output.end(), mount.begin(), mount.end());
     }
 
     return output;
@@ -146,35 +148,41 @@ namespace modules {
   /**
    * Output content using configured format tags
    */
-  bool fs_module::build(builder* builder, const string& tag) const {
+  bool fs_module::build(builder* builder, int id) const {
     auto& mount = m_mounts[m_index];
 
-    if (tag == TAG_BAR_FREE) {
-      builder->node(m_barfree->output(mount->percentage_free));
-    } else if (tag == TAG_BAR_USED) {
-      builder->node(m_barused->output(mount->percentage_used));
-    } else if (tag == TAG_RAMP_CAPACITY) {
-      builder->node(m_rampcapacity->get_by_percentage(mount->percentage_free));
-    } else if (tag == TAG_LABEL_MOUNTED) {
-      m_labelmounted->reset_tokens();
-      m_labelmounted->replace_token("%mountpoint%", mount->mountpoint);
-      m_labelmounted->replace_token("%type%", mount->type);
-      m_labelmounted->replace_token("%fsname%", mount->fsname);
-      m_labelmounted->replace_token("%percentage_free%", to_string(mount->percentage_free));
-      m_labelmounted->replace_token("%percentage_used%", to_string(mount->percentage_used));
-      m_labelmounted->replace_token(
-          "%total%", string_util::filesize(mount->bytes_total, m_fixed ? 2 : 0, m_fixed, m_bar.locale));
-      m_labelmounted->replace_token(
-          "%free%", string_util::filesize(mount->bytes_avail, m_fixed ? 2 : 0, m_fixed, m_bar.locale));
-      m_labelmounted->replace_token(
-          "%used%", string_util::filesize(mount->bytes_used, m_fixed ? 2 : 0, m_fixed, m_bar.locale));
-      builder->node(m_labelmounted);
-    } else if (tag == TAG_LABEL_UNMOUNTED) {
-      m_labelunmounted->reset_tokens();
-      m_labelunmounted->replace_token("%mountpoint%", mount->mountpoint);
-      builder->node(m_labelunmounted);
-    } else {
-      return false;
+    switch (static_cast<tag>(id)) {
+      case tag::BAR_FREE:
+        builder->append(m_barfree->output(mount->percentage_free));
+        break;
+      case tag::BAR_USED:
+        builder->append(m_barused->output(mount->percentage_used));
+        break;
+      case tag::RAMP_CAPACITY:
+        builder->node(m_rampcapacity->get_by_percentage(mount->percentage_free));
+        break;
+      case tag::LABEL_MOUNTED:
+        m_labelmounted->reset_tokens();
+        m_labelmounted->replace_token("%mountpoint%", mount->mountpoint);
+        m_labelmounted->replace_token("%type%", mount->type);
+        m_labelmounted->replace_token("%fsname%", mount->fsname);
+        m_labelmounted->replace_token("%percentage_free%", to_string(mount->percentage_free));
+        m_labelmounted->replace_token("%percentage_used%", to_string(mount->percentage_used));
+        m_labelmounted->replace_token(
+            "%total%", string_util::filesize(mount->bytes_total, m_fixed ? 2 : 0, m_fixed, m_bar.locale));
+        m_labelmounted->replace_token(
+            "%free%", string_util::filesize(mount->bytes_avail, m_fixed ? 2 : 0, m_fixed, m_bar.locale));
+        m_labelmounted->replace_token(
+            "%used%", string_util::filesize(mount->bytes_used, m_fixed ? 2 : 0, m_fixed, m_bar.locale));
+        builder->node(m_labelmounted);
+        break;
+      case tag::LABEL_UNMOUNTED:
+        m_labelunmounted->reset_tokens();
+        m_labelunmounted->replace_token("%mountpoint%", mount->mountpoint);
+        builder->node(m_labelunmounted);
+        break;
+      default:
+        return false;
     }
 
     return true;
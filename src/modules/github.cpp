@@ -20,7 +20,7 @@ namespace modules {
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 60s);
     m_empty_notifications = m_conf.get(name(), "empty-notifications", m_empty_notifications);
 
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {{TAG_LABEL, tag::LABEL}});
 
     if (m_formatter->has(TAG_LABEL)) {
       m_label = load_optional_label(m_conf, name(), TAG_LABEL, "Notifications: %notifications%");
@@ -33,6 +33,13 @@ namespace modules {
     }
   }
 
+  /**
+   * Run updates on a dedicated thread since the request can take long
+   */
+  bool github_module::blocking() const {
+    return true;
+  }
+
   /**
    * Update module contents
    */
@@ -71,8 +78,8 @@ namespace modules {
   /**
    * Build module content
    */
-  bool github_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL) {
+  bool github_module::build(builder* builder, int id) const {
+    if (static_cast<tag>(id) == tag::LABEL) {
       builder->node(m_label);
     } else {
       return false;
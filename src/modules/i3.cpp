@@ -35,7 +35,8 @@ namespace modules {
     m_conf.warn_deprecated(name(), "wsname-maxlen", "%name:min:max%");
 
     // Add formats and create components
-    m_formatter->add(DEFAULT_FORMAT, DEFAULT_TAGS, {TAG_LABEL_STATE, TAG_LABEL_MODE});
+    m_formatter->add(DEFAULT_FORMAT, DEFAULT_TAGS,
+        {{TAG_LABEL_STATE, tag::LABEL_STATE}, {TAG_LABEL_MODE, tag::LABEL_MODE}});
 
     if (m_formatter->has(TAG_LABEL_STATE)) {
       m_statelabels.insert(
@@ -95,6 +96,10 @@ namespace modules {
     event_module::stop();
   }
 
+  vector<struct pollfd> i3_module::poll_descriptors() {
+    return {{m_ipc->get_event_socket_fd(), POLLIN, 0}};
+  }
+
   bool i3_module::has_event() {
     try {
       m_ipc->handle_event();
@@ -162,31 +167,41 @@ namespace modules {
     }
   }
 
-  bool i3_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL_MODE && m_modeactive) {
-      builder->node(m_modelabel);
-    } else if (tag == TAG_LABEL_STATE && !m_workspaces.empty()) {
-      if (m_scroll) {
-        builder->cmd(mousebtn::SCROLL_DOWN, EVENT_SCROLL_DOWN);
-        builder->cmd(mousebtn::SCROLL_UP, EVENT_SCROLL_UP);
-      }
+  bool i3_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL_MODE:
+        if (!m_modeactive) {
+          return false;
+        }
+        builder->node(m_modelabel);
+        break;
+      case tag::LABEL_STATE:
+        if (m_workspaces.empty()) {
+          return false;
+        }
 
-      for (auto&& ws : m_workspaces) {
-        if (m_click) {
-          builder->cmd(mousebtn::LEFT, string{EVENT_CLICK} + to_string(ws->index));
-          builder->node(ws->label);
-          builder->cmd_close();
-        } else {
-          builder->node(ws->label);
+        if (m_scroll) {
+          builder->cmd(mousebtn::SCROLL_DOWN, EVENT_SCROLL_DOWN);
+          builder->cmd(mousebtn::SCROLL_UP, EVENT_SCROLL_UP);
         }
-      }
 
-      if (m_scroll) {
-        builder->cmd_close();
-        builder->cmd_close();
-      }
-    } else {
-      return false;
+        for (auto&& ws : m_workspaces) {
+          if (m_click) {
+            builder->cmd(mousebtn::LEFT, string{EVENT_CLICK} + to_string(ws->index));
+            builder->node(ws->label);
+            builder->cmd_close();
+          } else {
+            builder->node(ws->label);
+          }
+        }
+
+        if (m_scroll) {
+          builder->cmd_close();
+          builder->cmd_close();
+        }
+        break;
+      default:
+        return false;
     }
 
     return true;
@@ -52,7 +52,7 @@ namespace modules {
       pid_token(hook->command);
     }
 
-    m_formatter->add(DEFAULT_FORMAT, TAG_OUTPUT, {TAG_OUTPUT});
+    m_formatter->add(DEFAULT_FORMAT, TAG_OUTPUT, {{TAG_OUTPUT, tag::OUTPUT}});
   }
 
   /**
@@ -70,11 +70,11 @@ namespace modules {
   /**
    * Wrap the output with defined mouse actions
    */
-  string ipc_module::get_output() {
+  display_list ipc_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     for (auto&& action : m_actions) {
       if (!action.second.empty()) {
@@ -82,15 +82,15 @@ namespace modules {
       }
     }
 
-    m_builder->append(output);
+    m_builder->append(move(output));
     return m_builder->flush();
   }
 
   /**
    * Output content retrieved from hook commands
    */
-  bool ipc_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_OUTPUT) {
+  bool ipc_module::build(builder* builder, int id) const {
+    if (static_cast<tag>(id) == tag::OUTPUT) {
       builder->node(m_output);
       return true;
     } else {
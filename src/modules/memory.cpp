@@ -17,7 +17,8 @@ namespace modules {
   memory_module::memory_module(const bar_settings& bar, string name_) : timer_module<memory_module>(bar, move(name_)) {
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 1s);
 
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_USED, TAG_BAR_FREE});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL,
+        {{TAG_LABEL, tag::LABEL}, {TAG_BAR_USED, tag::BAR_USED}, {TAG_BAR_FREE, tag::BAR_FREE}});
 
     if (m_formatter->has(TAG_BAR_USED)) {
       m_bar_memused = load_progressbar(m_bar, m_conf, name(), TAG_BAR_USED);
@@ -84,15 +85,19 @@ namespace modules {
     return true;
   }
 
-  bool memory_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_BAR_USED) {
-      builder->node(m_bar_memused->output(m_perc_memused));
-    } else if (tag == TAG_BAR_FREE) {
-      builder->node(m_bar_memfree->output(m_perc_memfree));
-    } else if (tag == TAG_LABEL) {
-      builder->node(m_label);
-    } else {
-      return false;
+  bool memory_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::BAR_USED:
+        builder->append(m_bar_memused->output(m_perc_memused));
+        break;
+      case tag::BAR_FREE:
+        builder->append(m_bar_memfree->output(m_perc_memfree));
+        break;
+      case tag::LABEL:
+        builder->node(m_label);
+        break;
+      default:
+        return false;
     }
     return true;
   }
@@ -16,7 +16,7 @@ namespace modules {
     default_format += TAG_LABEL_TOGGLE;
     default_format += TAG_MENU;
 
-    m_formatter->add(DEFAULT_FORMAT, default_format, {TAG_LABEL_TOGGLE, TAG_MENU});
+    m_formatter->add(DEFAULT_FORMAT, default_format, {{TAG_LABEL_TOGGLE, tag::LABEL_TOGGLE}, {TAG_MENU, tag::MENU}});
 
     if (m_formatter->has(TAG_LABEL_TOGGLE)) {
       m_labelopen = load_label(m_conf, name(), "label-open");
@@ -55,33 +55,40 @@ namespace modules {
     }
   }
 
-  bool menu_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL_TOGGLE && m_level == -1) {
-      builder->cmd(mousebtn::LEFT, string(EVENT_MENU_OPEN) + "0");
-      builder->node(m_labelopen);
-      builder->cmd_close();
-    } else if (tag == TAG_LABEL_TOGGLE && m_level > -1) {
-      builder->cmd(mousebtn::LEFT, EVENT_MENU_CLOSE);
-      builder->node(m_labelclose);
-      builder->cmd_close();
-    } else if (tag == TAG_MENU && m_level > -1) {
-      auto spacing = m_formatter->get(get_format())->spacing;
-      for (auto&& item : m_levels[m_level]->items) {
-        if (*m_labelseparator) {
-          if (item != m_levels[m_level]->items[0]) {
+  bool menu_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL_TOGGLE:
+        if (m_level == -1) {
+          builder->cmd(mousebtn::LEFT, string(EVENT_MENU_OPEN) + "0");
+          builder->node(m_labelopen);
+        } else {
+          builder->cmd(mousebtn::LEFT, EVENT_MENU_CLOSE);
+          builder->node(m_labelclose);
+        }
+        builder->cmd_close();
+        return true;
+      case tag::MENU: {
+        if (m_level == -1) {
+          return false;
+        }
+        auto spacing = m_formatter->get(get_format())->spacing;
+        for (auto&& item : m_levels[m_level]->items) {
+          if (*m_labelseparator) {
+            if (item != m_levels[m_level]->items[0]) {
+              builder->space(spacing);
+            }
+            builder->node(m_labelseparator);
             builder->space(spacing);
           }
-          builder->node(m_labelseparator);
-          builder->space(spacing);
+          builder->cmd(mousebtn::LEFT, item->exec);
+          builder->node(item->label);
+          builder->cmd_close();
         }
-        builder->cmd(mousebtn::LEFT, item->exec);
-        builder->node(item->label);
-        builder->cmd_close();
+        return true;
       }
-    } else {
-      return false;
+      default:
+        return false;
     }
-    return true;
   }
 
   bool menu_module::input(string&& cmd) {
@@ -9,10 +9,43 @@ POLYBAR_NS
 namespace modules {
   // module_format {{{
 
-  string module_format::decorate(builder* builder, string output) {
+  constexpr int module_format::LITERAL;
+
+  /**
+   * Split the format string into literal and tag segments
+   * and resolve the tags to their ids
+   *
+   * @note Needs to be called again whenever the value is changed
+   */
+  void module_format::compile() {
+    segments.clear();
+
+    size_t pos{0}, start, end;
+    while ((start = value.find('<', pos)) != string::npos && (end = value.find('>', start)) != string::npos) {
+      if (start > pos) {
+        segments.push_back({value.substr(pos, start - pos), LITERAL});
+      }
+
+      string name{value.substr(start, end - start + 1)};
+      auto tag = find_if(tags.begin(), tags.end(), [&](const format_tag& t) { return t.name == name; });
+
+      if (tag == tags.end()) {
+        throw undefined_format_tag(name + " is not a valid format tag");
+      }
+
+      segments.push_back({move(name), tag->id});
+      pos = end + 1;
+    }
+
+    if (pos < value.size()) {
+      segments.push_back({value.substr(pos), LITERAL});
+    }
+  }
+
+  display_list module_format::decorate(builder* builder, display_list output) {
     if (output.empty()) {
       builder->flush();
-      return "";
+      return {};
     }
 
     if (offset != 0) {
@@ -68,7 +101,8 @@ namespace modules {
   // }}}
   // module_formatter {{{
 
-  void module_formatter::add(string name, string fallback, vector<string>&& tags, vector<string>&& whitelist) {
+  void module_formatter::add(
+      string name, string fallback, vector<format_tag>&& tags, vector<format_tag>&& whitelist) {
     const auto formatdef = [&](
         const string& param, const auto& fallback) { return m_conf.get("settings", "format-" + param, fallback); };
 
@@ -85,6 +119,7 @@ namespace modules {
     format->margin = m_conf.get(m_modname, name + "-margin", formatdef("margin", format->margin));
     format->offset = m_conf.get(m_modname, name + "-offset", formatdef("offset", format->offset));
     format->tags.swap(tags);
+    format->tags.insert(format->tags.end(), whitelist.begin(), whitelist.end());
 
     try {
       format->prefix = load_label(m_conf, m_modname, name + "-prefix");
@@ -98,24 +133,10 @@ namespace modules {
       // suffix not defined
     }
 
-    vector<string> tag_collection;
-    tag_collection.reserve(format->tags.size() + whitelist.size());
-    tag_collection.insert(tag_collection.end(), format->tags.begin(), format->tags.end());
-    tag_collection.insert(tag_collection.end(), whitelist.begin(), whitelist.end());
-
-    size_t start, end;
-    string value{format->value};
-    while ((start = value.find('<')) != string::npos && (end = value.find('>', start)) != string::npos) {
-      if (start > 0) {
-        value.erase(0, start);
-        end -= start;
-        start = 0;
-      }
-      string tag{value.substr(start, end + 1)};
-      if (find(tag_collection.begin(), tag_collection.end(), tag) == tag_collection.end()) {
-        throw undefined_format_tag(tag + " is not a valid format tag for \"" + name + "\"");
-      }
-      value.erase(0, tag.size());
+    try {
+      format->compile();
+    } catch (const undefined_format_tag& err) {
+      throw undefined_format_tag(string{err.what()} + " for \"" + name + "\"");
     }
 
     m_formats.insert(make_pair(move(name), move(format)));
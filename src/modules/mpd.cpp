@@ -22,11 +22,14 @@ namespace modules {
     // Add formats and elements {{{
 
     m_formatter->add(FORMAT_ONLINE, TAG_LABEL_SONG,
-        {TAG_BAR_PROGRESS, TAG_TOGGLE, TAG_TOGGLE_STOP, TAG_LABEL_SONG, TAG_LABEL_TIME, TAG_ICON_RANDOM,
-            TAG_ICON_REPEAT, TAG_ICON_REPEAT_ONE, TAG_ICON_PREV, TAG_ICON_STOP, TAG_ICON_PLAY, TAG_ICON_PAUSE,
-            TAG_ICON_NEXT, TAG_ICON_SEEKB, TAG_ICON_SEEKF});
+        {{TAG_BAR_PROGRESS, tag::BAR_PROGRESS}, {TAG_TOGGLE, tag::TOGGLE}, {TAG_TOGGLE_STOP, tag::TOGGLE_STOP},
+            {TAG_LABEL_SONG, tag::LABEL_SONG}, {TAG_LABEL_TIME, tag::LABEL_TIME}, {TAG_ICON_RANDOM, tag::ICON_RANDOM},
+            {TAG_ICON_REPEAT, tag::ICON_REPEAT}, {TAG_ICON_REPEAT_ONE, tag::ICON_REPEAT_ONE},
+            {TAG_ICON_PREV, tag::ICON_PREV}, {TAG_ICON_STOP, tag::ICON_STOP}, {TAG_ICON_PLAY, tag::ICON_PLAY},
+            {TAG_ICON_PAUSE, tag::ICON_PAUSE}, {TAG_ICON_NEXT, tag::ICON_NEXT}, {TAG_ICON_SEEKB, tag::ICON_SEEKB},
+            {TAG_ICON_SEEKF, tag::ICON_SEEKF}});
 
-    m_formatter->add(FORMAT_OFFLINE, "", {TAG_LABEL_OFFLINE});
+    m_formatter->add(FORMAT_OFFLINE, "", {{TAG_LABEL_OFFLINE, tag::LABEL_OFFLINE}});
 
     m_icons = factory_util::shared<iconset>();
 
@@ -110,6 +113,43 @@ namespace modules {
     }
   }
 
+  /**
+   * Wait on the connection while it's in idle mode, the server
+   * replies as soon as one of the subsystems has changed
+   */
+  vector<struct pollfd> mpd_module::poll_descriptors() {
+    std::lock_guard<std::mutex> guard(m_updatelock);
+
+    if (!connected() || !m_status) {
+      return {};
+    }
+
+    try {
+      m_mpd->idle();
+    } catch (const mpd_exception& err) {
+      m_log.err("%s: %s", name(), err.what());
+      m_mpd.reset();
+      return {};
+    }
+
+    return {{m_mpd->get_fd(), POLLIN, 0}};
+  }
+
+  /**
+   * Wake up in time to refresh the elapsed time while playing
+   */
+  int mpd_module::poll_timeout() {
+    std::lock_guard<std::mutex> guard(m_updatelock);
+
+    if ((m_label_time || m_bar_progress) && m_status && m_status->match_state(mpdstate::PLAYING)) {
+      auto next = m_lastsync + chrono::milliseconds{static_cast<int>(m_synctime * 1000)};
+      auto remaining = chrono::duration_cast<chrono::milliseconds>(next - chrono::system_clock::now());
+      return std::max(0, static_cast<int>(remaining.count())) + 1;
+    }
+
+    return -1;
+  }
+
   bool mpd_module::has_event() {
     bool def = false;
 
@@ -246,50 +286,97 @@ namespace modules {
     return connected() ? FORMAT_ONLINE : FORMAT_OFFLINE;
   }
 
-  string mpd_module::get_output() {
+  display_list mpd_module::get_output() {
     if (m_status && m_status->get_queuelen() == 0) {
       m_log.info("%s: Hiding module since queue is empty", name());
-      return "";
+      return {};
     } else {
       return event_module::get_output();
     }
   }
 
-  bool mpd_module::build(builder* builder, const string& tag) const {
+  bool mpd_module::build(builder* builder, int id) const {
     bool is_playing = m_status && m_status->match_state(mpdstate::PLAYING);
     bool is_paused = m_status && m_status->match_state(mpdstate::PAUSED);
     bool is_stopped = m_status && m_status->match_state(mpdstate::STOPPED);
 
-    if (tag == TAG_LABEL_SONG && !is_stopped) {
-      builder->node(m_label_song);
-    } else if (tag == TAG_LABEL_TIME && !is_stopped) {
-      builder->node(m_label_time);
-    } else if (tag == TAG_BAR_PROGRESS && !is_stopped) {
-      builder->node(m_bar_progress->output(!m_status ? 0 : m_status->get_elapsed_percentage()));
-    } else if (tag == TAG_LABEL_OFFLINE) {
-      builder->node(m_label_offline);
-    } else if (tag == TAG_ICON_RANDOM) {
-      builder->cmd(mousebtn::LEFT, EVENT_RANDOM, m_icons->get("random"));
-    } else if (tag == TAG_ICON_REPEAT) {
-      builder->cmd(mousebtn::LEFT, EVENT_REPEAT, m_icons->get("repeat"));
-    } else if (tag == TAG_ICON_REPEAT_ONE) {
-      builder->cmd(mousebtn::LEFT, EVENT_REPEAT_ONE, m_icons->get("repeat_one"));
-    } else if (tag == TAG_ICON_PREV) {
-      builder->cmd(mousebtn::LEFT, EVENT_PREV, m_icons->get("prev"));
-    } else if ((tag == TAG_ICON_STOP || tag == TAG_TOGGLE_STOP) && (is_playing || is_paused)) {
-      builder->cmd(mousebtn::LEFT, EVENT_STOP, m_icons->get("stop"));
-    } else if ((tag == TAG_ICON_PAUSE || tag == TAG_TOGGLE) && is_playing) {
-      builder->cmd(mousebtn::LEFT, EVENT_PAUSE, m_icons->get("pause"));
-    } else if ((tag == TAG_ICON_PLAY || tag == TAG_TOGGLE || tag == TAG_TOGGLE_STOP) && !is_playing) {
-      builder->cmd(mousebtn::LEFT, EVENT_PLAY, m_icons->get("play"));
-    } else if (tag == TAG_ICON_NEXT) {
-      builder->cmd(mousebtn::LEFT, EVENT_NEXT, m_icons->get("next"));
-    } else if (tag == TAG_ICON_SEEKB) {
-      builder->cmd(mousebtn::LEFT, EVENT_SEEK + "-5"s, m_icons->get("seekb"));
-    } else if (tag == TAG_ICON_SEEKF) {
-      builder->cmd(mousebtn::LEFT, EVENT_SEEK + "+5"s, m_icons->get("seekf"));
-    } else {
-      return false;
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL_SONG:
+        if (is_stopped) {
+          return false;
+        }
+        builder->node(m_label_song);
+        break;
+      case tag::LABEL_TIME:
+        if (is_stopped) {
+          return false;
+        }
+        builder->node(m_label_time);
+        break;
+      case tag::BAR_PROGRESS:
+        if (is_stopped) {
+          return false;
+        }
+        builder->append(m_bar_progress->output(!m_status ? 0 : m_status->get_elapsed_percentage()));
+        break;
+      case tag::LABEL_OFFLINE:
+        builder->node(m_label_offline);
+        break;
+      case tag::ICON_RANDOM:
+        builder->cmd(mousebtn::LEFT, EVENT_RANDOM, m_icons->get("random"));
+        break;
+      case tag::ICON_REPEAT:
+        builder->cmd(mousebtn::LEFT, EVENT_REPEAT, m_icons->get("repeat"));
+        break;
+      case tag::ICON_REPEAT_ONE:
+        builder->cmd(mousebtn::LEFT, EVENT_REPEAT_ONE, m_icons->get("repeat_one"));
+        break;
+      case tag::ICON_PREV:
+        builder->cmd(mousebtn::LEFT, EVENT_PREV, m_icons->get("prev"));
+        break;
+      case tag::ICON_STOP:
+        if (!is_playing && !is_paused) {
+          return false;
+        }
+        builder->cmd(mousebtn::LEFT, EVENT_STOP, m_icons->get("stop"));
+        break;
+      case tag::TOGGLE_STOP:
+        if (is_playing || is_paused) {
+          builder->cmd(mousebtn::LEFT, EVENT_STOP, m_icons->get("stop"));
+        } else {
+          builder->cmd(mousebtn::LEFT, EVENT_PLAY, m_icons->get("play"));
+        }
+        break;
+      case tag::ICON_PAUSE:
+        if (!is_playing) {
+          return false;
+        }
+        builder->cmd(mousebtn::LEFT, EVENT_PAUSE, m_icons->get("pause"));
+        break;
+      case tag::TOGGLE:
+        if (is_playing) {
+          builder->cmd(mousebtn::LEFT, EVENT_PAUSE, m_icons->get("pause"));
+        } else {
+          builder->cmd(mousebtn::LEFT, EVENT_PLAY, m_icons->get("play"));
+        }
+        break;
+      case tag::ICON_PLAY:
+        if (is_playing) {
+          return false;
+        }
+        builder->cmd(mousebtn::LEFT, EVENT_PLAY, m_icons->get("play"));
+        break;
+      case tag::ICON_NEXT:
+        builder->cmd(mousebtn::LEFT, EVENT_NEXT, m_icons->get("next"));
+        break;
+      case tag::ICON_SEEKB:
+        builder->cmd(mousebtn::LEFT, EVENT_SEEK + "-5"s, m_icons->get("seekb"));
+        break;
+      case tag::ICON_SEEKF:
+        builder->cmd(mousebtn::LEFT, EVENT_SEEK + "+5"s, m_icons->get("seekf"));
+        break;
+      default:
+        return false;
     }
 
     return true;
@@ -24,8 +24,10 @@ namespace modules {
     m_conf.warn_deprecated(name(), "udspeed-minwidth", "%downspeed:min:max% and %upspeed:min:max%");
 
     // Add formats
-    m_formatter->add(FORMAT_CONNECTED, TAG_LABEL_CONNECTED, {TAG_RAMP_SIGNAL, TAG_RAMP_QUALITY, TAG_LABEL_CONNECTED});
-    m_formatter->add(FORMAT_DISCONNECTED, TAG_LABEL_DISCONNECTED, {TAG_LABEL_DISCONNECTED});
+    m_formatter->add(FORMAT_CONNECTED, TAG_LABEL_CONNECTED,
+        {{TAG_RAMP_SIGNAL, tag::RAMP_SIGNAL}, {TAG_RAMP_QUALITY, tag::RAMP_QUALITY},
+            {TAG_LABEL_CONNECTED, tag::LABEL_CONNECTED}});
+    m_formatter->add(FORMAT_DISCONNECTED, TAG_LABEL_DISCONNECTED, {{TAG_LABEL_DISCONNECTED, tag::LABEL_DISCONNECTED}});
 
     // Create elements for format-connected
     if (m_formatter->has(TAG_RAMP_SIGNAL, FORMAT_CONNECTED)) {
@@ -49,7 +51,8 @@ namespace modules {
     // Create elements for format-packetloss if we are told to test connectivity
     if (m_ping_nth_update > 0) {
       m_formatter->add(FORMAT_PACKETLOSS, TAG_LABEL_CONNECTED,
-          {TAG_ANIMATION_PACKETLOSS, TAG_LABEL_PACKETLOSS, TAG_LABEL_CONNECTED});
+          {{TAG_ANIMATION_PACKETLOSS, tag::ANIMATION_PACKETLOSS}, {TAG_LABEL_PACKETLOSS, tag::LABEL_PACKETLOSS},
+              {TAG_LABEL_CONNECTED, tag::LABEL_CONNECTED}});
 
       if (m_formatter->has(TAG_LABEL_PACKETLOSS, FORMAT_PACKETLOSS)) {
         m_label[connection_state::PACKETLOSS] = load_optional_label(m_conf, name(), TAG_LABEL_PACKETLOSS, "");
@@ -66,17 +69,36 @@ namespace modules {
       m_wired = factory_util::unique<net::wired_network>(m_interface);
     };
 
-    // We only need to start the subthread if the packetloss animation is used
+    // We only need to refresh the output if the packetloss animation is used
     if (m_animation_packetloss) {
-      m_threads.emplace_back(thread(&network_module::subthread_routine, this));
+      m_animation_timer = scheduler::make().add([this] { animate(); });
+      scheduler::make().arm(m_animation_timer, 0ms);
     }
   }
 
+  /**
+   * Remove the animation timer before the module locks are taken
+   * since a running animation frame needs them to finish
+   */
+  void network_module::stop() {
+    if (m_animation_timer) {
+      scheduler::make().remove(m_animation_timer);
+    }
+    this->timer_module::stop();
+  }
+
   void network_module::teardown() {
     m_wireless.reset();
     m_wired.reset();
   }
 
+  /**
+   * Pinging blocks the update for several seconds
+   */
+  bool network_module::blocking() const {
+    return m_ping_nth_update > 0;
+  }
+
   bool network_module::update() {
     net::network* network =
         m_wireless ? static_cast<net::network*>(m_wireless.get()) : static_cast<net::network*>(m_wired.get());
@@ -145,37 +167,40 @@ namespace modules {
     }
   }
 
-  bool network_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL_CONNECTED) {
-      builder->node(m_label.at(connection_state::CONNECTED));
-    } else if (tag == TAG_LABEL_DISCONNECTED) {
-      builder->node(m_label.at(connection_state::DISCONNECTED));
-    } else if (tag == TAG_LABEL_PACKETLOSS) {
-      builder->node(m_label.at(connection_state::PACKETLOSS));
-    } else if (tag == TAG_ANIMATION_PACKETLOSS) {
-      builder->node(m_animation_packetloss->get());
-    } else if (tag == TAG_RAMP_SIGNAL) {
-      builder->node(m_ramp_signal->get_by_percentage(m_signal));
-    } else if (tag == TAG_RAMP_QUALITY) {
-      builder->node(m_ramp_quality->get_by_percentage(m_quality));
-    } else {
-      return false;
+  bool network_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL_CONNECTED:
+        builder->node(m_label.at(connection_state::CONNECTED));
+        break;
+      case tag::LABEL_DISCONNECTED:
+        builder->node(m_label.at(connection_state::DISCONNECTED));
+        break;
+      case tag::LABEL_PACKETLOSS:
+        builder->node(m_label.at(connection_state::PACKETLOSS));
+        break;
+      case tag::ANIMATION_PACKETLOSS:
+        builder->node(m_animation_packetloss->get());
+        break;
+      case tag::RAMP_SIGNAL:
+        builder->node(m_ramp_signal->get_by_percentage(m_signal));
+        break;
+      case tag::RAMP_QUALITY:
+        builder->node(m_ramp_quality->get_by_percentage(m_quality));
+        break;
+      default:
+        return false;
     }
     return true;
   }
 
-  void network_module::subthread_routine() {
-    const chrono::milliseconds framerate{m_animation_packetloss->framerate()};
-    const auto dur = chrono::duration<double>(framerate);
-
-    while (running()) {
-      if (m_connected && m_packetloss) {
-        broadcast();
-      }
-      sleep(dur);
+  void network_module::animate() {
+    if (!running()) {
+      return;
     }
-
-    m_log.trace("%s: Reached end of network subthread", name());
+    if (m_connected && m_packetloss) {
+      broadcast();
+    }
+    scheduler::make().arm(m_animation_timer, chrono::milliseconds{m_animation_packetloss->framerate()});
   }
 }
 
@@ -1,3 +1,7 @@
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <csignal>
+
 #include "modules/script.hpp"
 #include "drawtypes/label.hpp"
 #include "modules/meta/base.inl"
@@ -13,6 +17,59 @@ namespace modules {
    */
   script_module::script_module(const bar_settings& bar, string name_)
       : module<script_module>(bar, move(name_)), m_handler([&]() -> function<chrono::duration<double>()> {
+        // Handler for co-process commands {{{
+
+        if (m_conf.get(name(), "coprocess", false)) {
+          return [&] {
+            if (!m_command || !m_command->is_running()) {
+              string exec{string_util::replace_all(m_exec, "%counter%", to_string(++m_counter))};
+              m_log.info("%s: Starting co-process: \"%s\"", name(), exec);
+              m_command = command_util::make_command(exec);
+              m_buffer.clear();
+              m_pending.clear();
+
+              try {
+                m_command->exec(false);
+                // A co-process that stops reading must not block the worker
+                io_util::set_nonblock(m_command->get_stdin(PIPE_WRITE));
+              } catch (const exception& err) {
+                m_log.err("%s: %s", name(), err.what());
+                throw module_error("Failed to execute command, stopping module...");
+              }
+            }
+
+            {
+              std::lock_guard<mutex> guard(m_inputlock);
+              m_input.emplace_back("update");
+            }
+
+            // Wait for replies and forward clicks until the next update is due
+            auto deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::milliseconds>(m_interval);
+            int fd = m_command->get_stdout(PIPE_READ);
+
+            while (!m_stopping && m_command->is_running()) {
+              send_input(deadline);
+              auto timeout = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+              if (timeout.count() <= 0) {
+                break;
+              } else if (wait_readable(fd, timeout.count()) && !read_lines(fd)) {
+                m_log.warn("%s: Co-process closed its output, restarting...", name());
+                m_command->terminate();
+                break;
+              }
+            }
+
+            if (m_stopping) {
+              return chrono::duration<double>{0};
+            } else if (m_command && !m_command->is_running()) {
+              return std::max(m_command->get_exit_status() == 0 ? m_interval : 1s, m_interval);
+            } else {
+              return chrono::duration<double>{0};
+            }
+          };
+        }
+
+        // }}}
         // Handler for continuous tail commands {{{
 
         if (m_conf.get(name(), "tail", false)) {
@@ -21,6 +78,7 @@ namespace modules {
               string exec{string_util::replace_all(m_exec, "%counter%", to_string(++m_counter))};
               m_log.info("%s: Invoking shell command: \"%s\"", name(), exec);
               m_command = command_util::make_command(exec);
+              m_buffer.clear();
 
               try {
                 m_command->exec(false);
@@ -31,12 +89,9 @@ namespace modules {
             }
 
             int fd = m_command->get_stdout(PIPE_READ);
-            while (!m_stopping && fd != -1 && m_command->is_running() && !io_util::poll(fd, POLLHUP, 0)) {
-              if (!io_util::poll_read(fd, 25)) {
-                continue;
-              } else if ((m_output = m_command->readline()) != m_prev) {
-                m_prev = m_output;
-                broadcast();
+            while (!m_stopping && fd != -1 && m_command->is_running()) {
+              if (wait_readable(fd, -1) && !read_lines(fd)) {
+                break;
               }
             }
 
@@ -84,6 +139,14 @@ namespace modules {
     m_exec_if = m_conf.get(name(), "exec-if", m_exec_if);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 5s);
 
+    if ((m_coprocess = m_conf.get(name(), "coprocess", false)) && m_conf.get(name(), "tail", false)) {
+      m_log.warn("%s: Both `coprocess` and `tail` are enabled, running as co-process", name());
+    }
+
+    if ((m_wakeupfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) {
+      throw module_error("Failed to create wakeup channel");
+    }
+
     // Load configured click handlers
     m_actions[mousebtn::LEFT] = m_conf.get(name(), "click-left", ""s);
     m_actions[mousebtn::MIDDLE] = m_conf.get(name(), "click-middle", ""s);
@@ -91,18 +154,46 @@ namespace modules {
     m_actions[mousebtn::SCROLL_UP] = m_conf.get(name(), "scroll-up", ""s);
     m_actions[mousebtn::SCROLL_DOWN] = m_conf.get(name(), "scroll-down", ""s);
 
+    // Forward clicks without a configured command to the co-process
+    if (m_coprocess) {
+      const string prefix{EVENT_CLICK + name() + ":"};
+      const map<mousebtn, string> events{{mousebtn::LEFT, "left"}, {mousebtn::MIDDLE, "middle"},
+          {mousebtn::RIGHT, "right"}, {mousebtn::SCROLL_UP, "scroll-up"}, {mousebtn::SCROLL_DOWN, "scroll-down"}};
+
+      for (const auto& evt : events) {
+        if (m_actions[evt.first].empty()) {
+          m_actions[evt.first] = prefix + evt.second;
+        }
+      }
+    }
+
     // Setup formatting
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {{TAG_LABEL, tag::LABEL}});
     if (m_formatter->has(TAG_LABEL)) {
       m_label = load_optional_label(m_conf, name(), "label", "%output%");
     }
   }
 
+  /**
+   * Release the wakeup channel
+   */
+  script_module::~script_module() {
+    if (m_wakeupfd != -1) {
+      close(m_wakeupfd);
+    }
+  }
+
   /**
    * Start the module worker
    */
   void script_module::start() {
     m_mainthread = thread([&] {
+      // Let writes to an exited co-process fail with EPIPE instead of terminating the bar
+      sigset_t sigmask;
+      sigemptyset(&sigmask);
+      sigaddset(&sigmask, SIGPIPE);
+      pthread_sigmask(SIG_BLOCK, &sigmask, nullptr);
+
       try {
         while (running() && !m_stopping) {
           if (check_condition()) {
@@ -126,6 +217,11 @@ namespace modules {
     m_stopping = true;
     wakeup();
 
+    uint64_t value{1};
+    if (write(m_wakeupfd, &value, sizeof(value)) == -1) {
+      m_log.err("%s: Failed to interrupt command output wait", name());
+    }
+
     std::lock_guard<decltype(m_handler)> guard(m_handler);
 
     m_command.reset();
@@ -148,6 +244,184 @@ namespace modules {
     return false;
   }
 
+  /**
+   * Wait until the command has written something, has exited or the wait got interrupted
+   *
+   * An exited command is collected right away once its remaining output has been read
+   *
+   * @param timeout_ms Maximum time to wait, -1 to wait indefinitely
+   * @return true if the command output is ready to be read
+   */
+  bool script_module::wait_readable(int fd, int timeout_ms) {
+    struct pollfd fds[3] {};
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_wakeupfd;
+    fds[1].events = POLLIN;
+    fds[2].fd = m_command->get_pidfd();
+    fds[2].events = POLLIN;
+
+    if (::poll(fds, 3, timeout_ms) <= 0) {
+      return false;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      uint64_t count;
+      while (read(m_wakeupfd, &count, sizeof(count)) > 0) {
+        ;
+      }
+    }
+
+    if (fds[0].revents & (POLLIN | POLLHUP)) {
+      return true;
+    } else if (fds[2].revents & POLLIN) {
+      m_command->wait();
+    }
+
+    return false;
+  }
+
+  /**
+   * Read the available command output and show the last complete line
+   *
+   * @return false once the command has closed its output
+   */
+  bool script_module::read_lines(int fd) {
+    char buffer[BUFSIZ];
+    ssize_t bytes{read(fd, buffer, sizeof(buffer))};
+
+    if (bytes <= 0) {
+      return bytes == -1 && (errno == EAGAIN || errno == EINTR);
+    }
+
+    m_buffer.append(buffer, bytes);
+
+    size_t pos;
+    while ((pos = m_buffer.find('\n')) != string::npos) {
+      m_output = m_buffer.substr(0, pos);
+      m_buffer.erase(0, pos + 1);
+
+      if (m_output != m_prev) {
+        m_prev = m_output;
+        broadcast();
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Write the pending messages to the co-process
+   *
+   * Messages that don't fit before the deadline are kept for the next call
+   */
+  void script_module::send_input(chrono::steady_clock::time_point deadline) {
+    int fd = m_command->get_stdin(PIPE_WRITE);
+    int output_fd = m_command->get_stdout(PIPE_READ);
+
+    while (!m_stopping) {
+      if (m_pending.empty()) {
+        vector<string> messages;
+        {
+          std::lock_guard<mutex> guard(m_inputlock);
+          messages.swap(m_input);
+        }
+
+        if (messages.empty()) {
+          return;
+        }
+
+        for (auto&& msg : messages) {
+          m_pending += msg + '\n';
+        }
+      }
+
+      if (!write_input(fd, output_fd, deadline)) {
+        return;
+      }
+    }
+  }
+
+  /**
+   * Write the pending data to the co-process stdin, waiting while its pipe is full
+   *
+   * The output of the co-process is read during the wait, so that a co-process
+   * blocked on writing its reply gets to read its input again. The wait is given
+   * up when the deadline passes or the module stops.
+   *
+   * @return false if the data could not be written completely
+   */
+  bool script_module::write_input(int fd, int output_fd, chrono::steady_clock::time_point deadline) {
+    while (!m_pending.empty()) {
+      ssize_t bytes{write(fd, m_pending.data(), m_pending.size())};
+
+      if (bytes >= 0) {
+        m_pending.erase(0, bytes);
+        continue;
+      } else if (errno != EAGAIN && errno != EINTR) {
+        m_log.err("%s: Failed to write to co-process (%s)", name(), strerror(errno));
+        m_pending.clear();
+        return false;
+      }
+
+      auto timeout = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+      if (timeout.count() <= 0) {
+        return false;
+      }
+
+      struct pollfd fds[3] {};
+      fds[0].fd = fd;
+      fds[0].events = POLLOUT;
+      fds[1].fd = m_wakeupfd;
+      fds[1].events = POLLIN;
+      fds[2].fd = output_fd;
+      fds[2].events = POLLIN;
+
+      if (::poll(fds, 3, timeout.count()) == -1 && errno != EINTR) {
+        return false;
+      }
+
+      if (fds[1].revents & POLLIN) {
+        uint64_t count;
+        while (read(m_wakeupfd, &count, sizeof(count)) > 0) {
+          ;
+        }
+      }
+
+      if (m_stopping) {
+        return false;
+      } else if ((fds[2].revents & (POLLIN | POLLHUP)) && !read_lines(output_fd)) {
+        // The closed output is noticed by the caller's next wait
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Forward click events to the co-process
+   */
+  bool script_module::input(string&& cmd) {
+    const string prefix{EVENT_CLICK + name() + ":"};
+
+    if (!m_coprocess || cmd.compare(0, prefix.size(), prefix) != 0) {
+      return false;
+    }
+
+    {
+      std::lock_guard<mutex> guard(m_inputlock);
+      m_input.emplace_back("click " + cmd.substr(prefix.size()));
+    }
+
+    uint64_t value{1};
+    if (write(m_wakeupfd, &value, sizeof(value)) == -1) {
+      m_log.err("%s: Failed to forward click event", name());
+    }
+
+    return true;
+  }
+
   /**
    * Process mutex wrapped script handler
    */
@@ -159,9 +433,9 @@ namespace modules {
   /**
    * Generate module output
    */
-  string script_module::get_output() {
+  display_list script_module::get_output() {
     if (m_output.empty()) {
-      return "";
+      return {};
     }
 
     if (m_label) {
@@ -170,7 +444,7 @@ namespace modules {
     }
 
     string cnt{to_string(m_counter)};
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     if (!m_actions[mousebtn::LEFT].empty()) {
       m_builder->cmd(mousebtn::LEFT, string_util::replace_all(m_actions[mousebtn::LEFT], "%counter%", cnt));
@@ -189,7 +463,7 @@ namespace modules {
           mousebtn::SCROLL_DOWN, string_util::replace_all(m_actions[mousebtn::SCROLL_DOWN], "%counter%", cnt));
     }
 
-    m_builder->append(output);
+    m_builder->append(move(output));
 
     return m_builder->flush();
   }
@@ -197,8 +471,8 @@ namespace modules {
   /**
    * Output format tags
    */
-  bool script_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL) {
+  bool script_module::build(builder* builder, int id) const {
+    if (static_cast<tag>(id) == tag::LABEL) {
       builder->node(m_label);
     } else {
       return false;
@@ -17,7 +17,8 @@ namespace modules {
   systray_module::systray_module(const bar_settings& bar, string name_)
       : static_module<systray_module>(bar, move(name_)), m_connection(connection::make()) {
     // Add formats and elements
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL_TOGGLE, {TAG_LABEL_TOGGLE, TAG_TRAY_CLIENTS});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL_TOGGLE,
+        {{TAG_LABEL_TOGGLE, tag::LABEL_TOGGLE}, {TAG_TRAY_CLIENTS, tag::TRAY_CLIENTS}});
 
     if (m_formatter->has(TAG_LABEL_TOGGLE)) {
       m_label = load_label(m_conf, name(), TAG_LABEL_TOGGLE);
@@ -39,17 +40,22 @@ namespace modules {
   /**
    * Build output
    */
-  bool systray_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL_TOGGLE) {
-      builder->cmd(mousebtn::LEFT, EVENT_TOGGLE);
-      builder->node(m_label);
-      builder->cmd_close();
-    } else if (tag == TAG_TRAY_CLIENTS && !m_hidden) {
-      builder->append(TRAY_PLACEHOLDER);
-    } else {
-      return false;
+  bool systray_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL_TOGGLE:
+        builder->cmd(mousebtn::LEFT, EVENT_TOGGLE);
+        builder->node(m_label);
+        builder->cmd_close();
+        return true;
+      case tag::TRAY_CLIENTS:
+        if (m_hidden) {
+          return false;
+        }
+        builder->append(TRAY_PLACEHOLDER);
+        return true;
+      default:
+        return false;
     }
-    return true;
   }
 
   /**
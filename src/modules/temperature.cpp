@@ -24,8 +24,8 @@ namespace modules {
       throw module_error("The file '" + m_path + "' does not exist");
     }
 
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_RAMP});
-    m_formatter->add(FORMAT_WARN, TAG_LABEL_WARN, {TAG_LABEL_WARN, TAG_RAMP});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {{TAG_LABEL, tag::LABEL}, {TAG_RAMP, tag::RAMP}});
+    m_formatter->add(FORMAT_WARN, TAG_LABEL_WARN, {{TAG_LABEL_WARN, tag::LABEL_WARN}, {TAG_RAMP, tag::RAMP}});
 
     if (m_formatter->has(TAG_LABEL)) {
       m_label[temp_state::NORMAL] = load_optional_label(m_conf, name(), TAG_LABEL, "%temperature%");
@@ -65,15 +65,19 @@ namespace modules {
     }
   }
 
-  bool temperature_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL) {
-      builder->node(m_label.at(temp_state::NORMAL));
-    } else if (tag == TAG_LABEL_WARN) {
-      builder->node(m_label.at(temp_state::WARN));
-    } else if (tag == TAG_RAMP) {
-      builder->node(m_ramp->get_by_percentage(m_perc));
-    } else {
-      return false;
+  bool temperature_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL:
+        builder->node(m_label.at(temp_state::NORMAL));
+        break;
+      case tag::LABEL_WARN:
+        builder->node(m_label.at(temp_state::WARN));
+        break;
+      case tag::RAMP:
+        builder->node(m_ramp->get_by_percentage(m_perc));
+        break;
+      default:
+        return false;
     }
     return true;
   }
@@ -16,17 +16,18 @@ namespace modules {
 
     m_formatter->get("content")->value =
         string_util::replace_all(m_formatter->get("content")->value, " ", BUILDER_SPACE_TOKEN);
+    m_formatter->get("content")->compile();
   }
 
   string text_module::get_format() const {
     return "content";
   }
 
-  string text_module::get_output() {
+  display_list text_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     auto click_left = m_conf.get(name(), "click-left", ""s);
     auto click_middle = m_conf.get(name(), "click-middle", ""s);
@@ -50,7 +51,7 @@ namespace modules {
       m_builder->cmd(mousebtn::SCROLL_DOWN, scroll_down);
     }
 
-    m_builder->append(output);
+    m_builder->append(move(output));
 
     return m_builder->flush();
   }
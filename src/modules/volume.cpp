@@ -68,8 +68,11 @@ namespace modules {
     }
 
     // Add formats and elements
-    m_formatter->add(FORMAT_VOLUME, TAG_LABEL_VOLUME, {TAG_RAMP_VOLUME, TAG_LABEL_VOLUME, TAG_BAR_VOLUME});
-    m_formatter->add(FORMAT_MUTED, TAG_LABEL_MUTED, {TAG_RAMP_VOLUME, TAG_LABEL_MUTED, TAG_BAR_VOLUME});
+    m_formatter->add(FORMAT_VOLUME, TAG_LABEL_VOLUME,
+        {{TAG_RAMP_VOLUME, tag::RAMP_VOLUME}, {TAG_LABEL_VOLUME, tag::LABEL_VOLUME},
+            {TAG_BAR_VOLUME, tag::BAR_VOLUME}});
+    m_formatter->add(FORMAT_MUTED, TAG_LABEL_MUTED,
+        {{TAG_RAMP_VOLUME, tag::RAMP_VOLUME}, {TAG_LABEL_MUTED, tag::LABEL_MUTED}, {TAG_BAR_VOLUME, tag::BAR_VOLUME}});
 
     if (m_formatter->has(TAG_BAR_VOLUME)) {
       m_bar_volume = load_progressbar(m_bar, m_conf, name(), TAG_BAR_VOLUME);
@@ -92,19 +95,42 @@ namespace modules {
     snd_config_update_free_global();
   }
 
+  vector<struct pollfd> volume_module::poll_descriptors() {
+    std::lock_guard<std::mutex> guard(m_updatelock);
+    vector<struct pollfd> fds;
+
+    try {
+      for (auto&& mixer : m_mixer) {
+        if (!mixer.second) {
+          continue;
+        }
+        auto mixer_fds = mixer.second->get_poll_descriptors();
+        fds.insert(fds.end(), mixer_fds.begin(), mixer_fds.end());
+      }
+      if (m_ctrl[control::HEADPHONE]) {
+        auto ctrl_fds = m_ctrl[control::HEADPHONE]->get_poll_descriptors();
+        fds.insert(fds.end(), ctrl_fds.begin(), ctrl_fds.end());
+      }
+    } catch (const alsa_exception& e) {
+      m_log.err("%s: %s", name(), e.what());
+    }
+
+    return fds;
+  }
+
   bool volume_module::has_event() {
-    // Poll for mixer and control events
+    // Check for mixer and control events once one of the descriptors is ready
     try {
-      if (m_mixer[mixer::MASTER] && m_mixer[mixer::MASTER]->wait(25)) {
+      if (m_mixer[mixer::MASTER] && m_mixer[mixer::MASTER]->wait(0)) {
         return true;
       }
-      if (m_mixer[mixer::SPEAKER] && m_mixer[mixer::SPEAKER]->wait(25)) {
+      if (m_mixer[mixer::SPEAKER] && m_mixer[mixer::SPEAKER]->wait(0)) {
         return true;
       }
-      if (m_mixer[mixer::HEADPHONE] && m_mixer[mixer::HEADPHONE]->wait(25)) {
+      if (m_mixer[mixer::HEADPHONE] && m_mixer[mixer::HEADPHONE]->wait(0)) {
         return true;
       }
-      if (m_ctrl[control::HEADPHONE] && m_ctrl[control::HEADPHONE]->wait(25)) {
+      if (m_ctrl[control::HEADPHONE] && m_ctrl[control::HEADPHONE]->wait(0)) {
         return true;
       }
     } catch (const alsa_exception& e) {
@@ -183,34 +209,41 @@ namespace modules {
     return m_muted ? FORMAT_MUTED : FORMAT_VOLUME;
   }
 
-  string volume_module::get_output() {
+  display_list volume_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     m_builder->cmd(mousebtn::LEFT, EVENT_TOGGLE_MUTE);
     m_builder->cmd(mousebtn::SCROLL_UP, EVENT_VOLUME_UP);
     m_builder->cmd(mousebtn::SCROLL_DOWN, EVENT_VOLUME_DOWN);
 
-    m_builder->append(output);
+    m_builder->append(move(output));
 
     return m_builder->flush();
   }
 
-  bool volume_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_BAR_VOLUME) {
-      builder->node(m_bar_volume->output(m_volume));
-    } else if (tag == TAG_RAMP_VOLUME && (!m_headphones || !*m_ramp_headphones)) {
-      builder->node(m_ramp_volume->get_by_percentage(m_volume));
-    } else if (tag == TAG_RAMP_VOLUME && m_headphones && *m_ramp_headphones) {
-      builder->node(m_ramp_headphones->get_by_percentage(m_volume));
-    } else if (tag == TAG_LABEL_VOLUME) {
-      builder->node(m_label_volume);
-    } else if (tag == TAG_LABEL_MUTED) {
-      builder->node(m_label_muted);
-    } else {
-      return false;
+  bool volume_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::BAR_VOLUME:
+        builder->append(m_bar_volume->output(m_volume));
+        break;
+      case tag::RAMP_VOLUME:
+        if (m_headphones && *m_ramp_headphones) {
+          builder->node(m_ramp_headphones->get_by_percentage(m_volume));
+        } else {
+          builder->node(m_ramp_volume->get_by_percentage(m_volume));
+        }
+        break;
+      case tag::LABEL_VOLUME:
+        builder->node(m_label_volume);
+        break;
+      case tag::LABEL_MUTED:
+        builder->node(m_label_muted);
+        break;
+      default:
+        return false;
     }
     return true;
   }
@@ -60,7 +60,7 @@ namespace modules {
     m_connection.select_input_checked(m_proxy, XCB_RANDR_NOTIFY_MASK_OUTPUT_PROPERTY);
 
     // Add formats and elements
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR, TAG_RAMP});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {{TAG_LABEL, tag::LABEL}, {TAG_BAR, tag::BAR}, {TAG_RAMP, tag::RAMP}});
 
     if (m_formatter->has(TAG_LABEL)) {
       m_label = load_optional_label(m_conf, name(), TAG_LABEL, "%percentage%%");
@@ -114,16 +114,16 @@ namespace modules {
   /**
    * Generate the module output
    */
-  string xbacklight_module::get_output() {
+  display_list xbacklight_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapped
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     m_builder->cmd(mousebtn::SCROLL_UP, EVENT_SCROLLUP);
     m_builder->cmd(mousebtn::SCROLL_DOWN, EVENT_SCROLLDOWN);
 
-    m_builder->append(output);
+    m_builder->append(move(output));
 
     m_builder->cmd_close();
     m_builder->cmd_close();
@@ -134,15 +134,19 @@ namespace modules {
   /**
    * Output content as defined in the config
    */
-  bool xbacklight_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_BAR) {
-      builder->node(m_progressbar->output(m_percentage));
-    } else if (tag == TAG_RAMP) {
-      builder->node(m_ramp->get_by_percentage(m_percentage));
-    } else if (tag == TAG_LABEL) {
-      builder->node(m_label);
-    } else {
-      return false;
+  bool xbacklight_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::BAR:
+        builder->append(m_progressbar->output(m_percentage));
+        break;
+      case tag::RAMP:
+        builder->node(m_ramp->get_by_percentage(m_percentage));
+        break;
+      case tag::LABEL:
+        builder->node(m_label);
+        break;
+      default:
+        return false;
     }
     return true;
   }
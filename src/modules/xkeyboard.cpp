@@ -21,7 +21,8 @@ namespace modules {
     m_blacklist = m_conf.get_list(name(), "blacklist", {});
 
     // Add formats and elements
-    m_formatter->add(DEFAULT_FORMAT, FORMAT_DEFAULT, {TAG_LABEL_LAYOUT, TAG_LABEL_INDICATOR});
+    m_formatter->add(DEFAULT_FORMAT, FORMAT_DEFAULT,
+        {{TAG_LABEL_LAYOUT, tag::LABEL_LAYOUT}, {TAG_LABEL_INDICATOR, tag::LABEL_INDICATOR}});
 
     if (m_formatter->has(TAG_LABEL_LAYOUT)) {
       m_layout = load_optional_label(m_conf, name(), TAG_LABEL_LAYOUT, "%layout%");
@@ -80,15 +81,15 @@ namespace modules {
    * Build module output and wrap it in a click handler use
    * to cycle between configured layout groups
    */
-  string xkeyboard_module::get_output() {
-    string output{module::get_output()};
+  display_list xkeyboard_module::get_output() {
+    display_list output{module::get_output()};
 
     if (m_keyboard && m_keyboard->size() > 1) {
       m_builder->cmd(mousebtn::LEFT, EVENT_SWITCH);
-      m_builder->append(output);
+      m_builder->append(move(output));
       m_builder->cmd_close();
     } else {
-      m_builder->append(output);
+      m_builder->append(move(output));
     }
 
     return m_builder->flush();
@@ -97,23 +98,24 @@ namespace modules {
   /**
    * Map format tags to content
    */
-  bool xkeyboard_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL_LAYOUT) {
-      builder->node(m_layout);
-    } else if (tag == TAG_LABEL_INDICATOR && !m_indicators.empty()) {
-      size_t n{0};
-      for (auto&& indicator : m_indicators) {
-        if (n++) {
-          builder->space(m_formatter->get(DEFAULT_FORMAT)->spacing);
+  bool xkeyboard_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL_LAYOUT:
+        builder->node(m_layout);
+        return true;
+      case tag::LABEL_INDICATOR: {
+        size_t n{0};
+        for (auto&& indicator : m_indicators) {
+          if (n++) {
+            builder->space(m_formatter->get(DEFAULT_FORMAT)->spacing);
+          }
+          builder->node(indicator.second);
         }
-        builder->node(indicator.second);
+        return n > 0;
       }
-      return n > 0;
-    } else {
-      return false;
+      default:
+        return false;
     }
-
-    return true;
   }
 
   /**
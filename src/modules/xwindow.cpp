@@ -74,7 +74,7 @@ namespace modules {
     }
 
     // Add formats and elements
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {{TAG_LABEL, tag::LABEL}});
 
     if (m_formatter->has(TAG_LABEL)) {
       m_label = load_optional_label(m_conf, name(), TAG_LABEL, "%title%");
@@ -127,8 +127,8 @@ namespace modules {
   /**
    * Output content as defined in the config
    */
-  bool xwindow_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL && m_label && m_label.get()) {
+  bool xwindow_module::build(builder* builder, int id) const {
+    if (static_cast<tag>(id) == tag::LABEL && m_label && m_label.get()) {
       builder->node(m_label);
       return true;
     }
@@ -48,7 +48,8 @@ namespace modules {
     }
 
     // Add formats and elements
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL_STATE, {TAG_LABEL_STATE, TAG_LABEL_MONITOR});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL_STATE,
+        {{TAG_LABEL_STATE, tag::LABEL_STATE}, {TAG_LABEL_MONITOR, tag::LABEL_MONITOR}});
 
     if (m_formatter->has(TAG_LABEL_MONITOR)) {
       m_monitorlabel = load_optional_label(m_conf, name(), "label-monitor", DEFAULT_LABEL_MONITOR);
@@ -223,22 +224,23 @@ namespace modules {
   /**
    * Generate module output
    */
-  string xworkspaces_module::get_output() {
+  display_list xworkspaces_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapped
     // with the cmd handlers
-    string output;
+    display_list output;
     for (m_index = 0; m_index < m_viewports.size(); m_index++) {
       if (m_index > 0) {
         m_builder->space(m_formatter->get(DEFAULT_FORMAT)->spacing);
       }
-      output += module::get_output();
+      auto viewport = module::get_output();
+      output.insert(output.end(), viewport.begin(), viewport.end());
     }
 
     m_builder->cmd(mousebtn::SCROLL_DOWN, string{EVENT_PREFIX} + string{EVENT_SCROLL_DOWN});
     m_builder->cmd(mousebtn::SCROLL_UP, string{EVENT_PREFIX} + string{EVENT_SCROLL_UP});
 
-    m_builder->append(output);
+    m_builder->append(move(output));
 
     m_builder->cmd_close();
     m_builder->cmd_close();
@@ -249,31 +251,34 @@ namespace modules {
   /**
    * Output content as defined in the config
    */
-  bool xworkspaces_module::build(builder* builder, const string& tag) const {
-    if (tag == TAG_LABEL_MONITOR) {
-      if (m_viewports[m_index]->state != viewport_state::NONE) {
+  bool xworkspaces_module::build(builder* builder, int id) const {
+    switch (static_cast<tag>(id)) {
+      case tag::LABEL_MONITOR:
+        if (m_viewports[m_index]->state == viewport_state::NONE) {
+          return false;
+        }
         builder->node(m_viewports[m_index]->label);
         return true;
-      } else {
-        return false;
-      }
-    } else if (tag == TAG_LABEL_STATE) {
-      unsigned int added_states = 0;
-      for (auto&& desktop : m_viewports[m_index]->desktops) {
-        if (desktop->label.get()) {
-          if (m_click && desktop->state != desktop_state::ACTIVE) {
-            builder->cmd(mousebtn::LEFT, string{EVENT_PREFIX} + string{EVENT_CLICK} + to_string(desktop->index));
-            builder->node(desktop->label);
-            builder->cmd_close();
-          } else {
-            builder->node(desktop->label);
+
+      case tag::LABEL_STATE: {
+        unsigned int added_states = 0;
+        for (auto&& desktop : m_viewports[m_index]->desktops) {
+          if (desktop->label.get()) {
+            if (m_click && desktop->state != desktop_state::ACTIVE) {
+              builder->cmd(mousebtn::LEFT, string{EVENT_PREFIX} + string{EVENT_CLICK} + to_string(desktop->index));
+              builder->node(desktop->label);
+              builder->cmd_close();
+            } else {
+              builder->node(desktop->label);
+            }
+            added_states++;
           }
-          added_states++;
         }
+        return added_states > 0;
       }
-      return added_states > 0;
-    } else {
-      return false;
+
+      default:
+        return false;
     }
   }
 
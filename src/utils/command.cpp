@@ -1,21 +1,16 @@
+#include <poll.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <csignal>
 #include <cstdlib>
 #include <utility>
 
+#include "components/reaper.hpp"
 #include "errors.hpp"
 #include "utils/command.hpp"
 #include "utils/io.hpp"
 #include "utils/process.hpp"
 
-#ifndef STDOUT_FILENO
-#define STDOUT_FILENO 1
-#endif
-#ifndef STDERR_FILENO
-#define STDERR_FILENO 2
-#endif
-
 POLYBAR_NS
 
 command::command(const logger& logger, string cmd) : m_log(logger), m_cmd(move(cmd)) {
@@ -43,82 +38,83 @@ command::~command() {
   if (m_stdout[PIPE_WRITE] > 0) {
     close(m_stdout[PIPE_WRITE]);
   }
+  if (m_pidfd != -1) {
+    close(m_pidfd);
+  }
 }
 
 /**
  * Execute the command
  */
 int command::exec(bool wait_for_completion) {
-  if ((m_forkpid = fork()) == -1) {
-    throw system_error("Failed to fork process");
-  }
-
-  if (process_util::in_forked_process(m_forkpid)) {
-    if (dup2(m_stdin[PIPE_READ], STDIN_FILENO) == -1) {
-      throw command_error("Failed to redirect stdin in child process");
-    }
-    if (dup2(m_stdout[PIPE_WRITE], STDOUT_FILENO) == -1) {
-      throw command_error("Failed to redirect stdout in child process");
-    }
-    if (dup2(m_stdout[PIPE_WRITE], STDERR_FILENO) == -1) {
-      throw command_error("Failed to redirect stderr in child process");
-    }
-
-    // Close file descriptors that won't be used by the child
-    if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
-      throw command_error("Failed to close fd");
-    }
-    if ((m_stdin[PIPE_WRITE] = close(m_stdin[PIPE_WRITE])) == -1) {
-      throw command_error("Failed to close fd");
-    }
-    if ((m_stdout[PIPE_READ] = close(m_stdout[PIPE_READ])) == -1) {
-      throw command_error("Failed to close fd");
-    }
-    if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
-      throw command_error("Failed to close fd");
-    }
+  m_forkpid = process_util::spawn_sh(m_cmd.c_str(), m_stdin[PIPE_READ], m_stdout[PIPE_WRITE],
+      {m_stdin[PIPE_READ], m_stdin[PIPE_WRITE], m_stdout[PIPE_READ], m_stdout[PIPE_WRITE]});
 
-    setpgid(m_forkpid, 0);
-    process_util::exec_sh(m_cmd.c_str());
-  } else {
-    // Close file descriptors that won't be used by the parent
-    if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
-      throw command_error("Failed to close fd");
-    }
-    if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
-      throw command_error("Failed to close fd");
-    }
+  // Close file descriptors that won't be used by the parent
+  if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
+    throw command_error("Failed to close fd");
+  }
+  if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
+    throw command_error("Failed to close fd");
+  }
 
-    if (wait_for_completion) {
-      auto status = wait();
-      m_forkpid = -1;
-      return status;
-    }
+  if (wait_for_completion) {
+    auto status = wait();
+    m_forkpid = -1;
+    return status;
   }
 
+  m_pidfd = process_util::open_pidfd(m_forkpid);
+  m_watched = true;
+  reaper::make().watch(m_forkpid, m_pidfd, [this](int status) {
+    m_forkstatus = status;
+    m_exited = true;
+  });
+
   return EXIT_SUCCESS;
 }
 
-void command::terminate() {
+/**
+ * Terminate the command and collect it
+ *
+ * The process group is sent SIGTERM first and SIGKILL if the command
+ * hasn't exited within the grace period
+ */
+void command::terminate(std::chrono::milliseconds grace) {
   if (is_running()) {
     m_log.trace("command: Sending SIGTERM to running child process (%d)", m_forkpid);
     killpg(m_forkpid, SIGTERM);
-    wait();
+
+    if (!wait_for(grace)) {
+      m_log.warn("command: Child process (%d) ignored SIGTERM, sending SIGKILL", m_forkpid);
+      killpg(m_forkpid, SIGKILL);
+      wait();
+    }
   }
   m_forkpid = -1;
 }
 
 /**
  * Check if command is running
+ *
+ * @note Doesn't poll the child, it's reported as running until it has been collected
  */
 bool command::is_running() {
-  return m_forkpid > 0 && process_util::wait_for_completion_nohang(m_forkpid, &m_forkstatus) > -1;
+  return m_forkpid > 0 && !m_exited;
 }
 
 /**
  * Wait for the child processs to finish
  */
 int command::wait() {
+  if (m_watched) {
+    m_watched = false;
+    if (!reaper::make().release(m_forkpid)) {
+      // Already collected by the reaper
+      return m_forkstatus;
+    }
+  }
+
   do {
     m_log.trace("command: Waiting for pid %d to finish...", m_forkpid);
 
@@ -139,9 +135,44 @@ int command::wait() {
     }
   } while (!WIFEXITED(m_forkstatus) && !WIFSIGNALED(m_forkstatus));
 
+  m_exited = true;
   return m_forkstatus;
 }
 
+/**
+ * Wait at most the given time for the child process to exit
+ *
+ * @return true if the child has been collected
+ */
+bool command::wait_for(std::chrono::milliseconds timeout) {
+  if (m_watched) {
+    m_watched = false;
+    if (!reaper::make().release(m_forkpid)) {
+      return true;
+    }
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+
+  while (process_util::wait_for_completion_nohang(m_forkpid, &m_forkstatus) != m_forkpid) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+    if (remaining.count() <= 0) {
+      return false;
+    } else if (m_pidfd != -1) {
+      struct pollfd fds[1] {};
+      fds[0].fd = m_pidfd;
+      fds[0].events = POLLIN;
+      ::poll(fds, 1, remaining.count());
+    } else {
+      ::poll(nullptr, 0, std::min(remaining.count(), 10L));
+    }
+  }
+
+  m_exited = true;
+  return true;
+}
+
 /**
  * Tail command output
  *
@@ -189,6 +220,15 @@ pid_t command::get_pid() {
   return m_forkpid;
 }
 
+/**
+ * Get descriptor that becomes readable once the command has exited
+ *
+ * @return -1 if pidfds aren't supported
+ */
+int command::get_pidfd() {
+  return m_pidfd;
+}
+
 /**
  * Get command exit status
  */
@@ -1,5 +1,8 @@
+#include <spawn.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <csignal>
 
 #include "errors.hpp"
 #include "utils/env.hpp"
@@ -45,6 +48,68 @@ namespace process_util {
     }
   }
 
+  /**
+   * Spawn command using shell
+   *
+   * Unlike fork() followed by exec_sh(), posix_spawn() doesn't copy the
+   * page tables of the parent, which is expensive for a large multithreaded
+   * process. The child runs in its own process group with its stdin
+   * connected to `fd_in` and both stdout and stderr connected to `fd_out`
+   *
+   * @param close_fds Descriptors that are closed in the child after the redirection
+   */
+  pid_t spawn_sh(const char* cmd, int fd_in, int fd_out, const vector<int>& close_fds) {
+    static const string shell{env_util::get("SHELL", "/bin/sh")};
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t sigmask;
+    pid_t pid{-1};
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fd_in, STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, fd_out, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, fd_out, STDERR_FILENO);
+    for (auto&& fd : close_fds) {
+      posix_spawn_file_actions_addclose(&actions, fd);
+    }
+
+    // Don't let the child inherit signals blocked by the calling thread
+    sigemptyset(&sigmask);
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setsigmask(&attr, &sigmask);
+
+    const char* argv[]{shell.c_str(), "-c", cmd, nullptr};
+    int err{posix_spawnp(&pid, shell.c_str(), &actions, &attr, const_cast<char* const*>(argv), environ)};
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (err != 0) {
+      errno = err;
+      throw system_error("posix_spawnp() failed");
+    }
+
+    return pid;
+  }
+
+  /**
+   * Get a descriptor that becomes readable once the process has exited
+   *
+   * @return -1 if pidfd_open(2) isn't supported
+   */
+  int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+  }
+
   /**
    * Wait for child process
    */
@@ -115,6 +115,13 @@ namespace socket_util {
 
     return fds[0].revents & events;
   }
+
+  /**
+   * Get the file descriptor of the connection
+   */
+  int unix_connection::get_file_descriptor() const {
+    return m_fd;
+  }
 }
 
 POLYBAR_NS_END
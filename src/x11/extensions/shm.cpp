@@ -0,0 +1,93 @@
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "x11/extensions/shm.hpp"
+#include "errors.hpp"
+#include "x11/connection.hpp"
+
+POLYBAR_NS
+
+namespace shm_util {
+  /**
+   * Query for the MIT-SHM extension
+   */
+  void query_extension(connection& conn) {
+    auto reply = xcb_shm_query_version_reply(conn, xcb_shm_query_version(conn), nullptr);
+
+    if (reply == nullptr) {
+      throw application_error("Missing X extension: MIT-SHM");
+    }
+
+    free(reply);
+  }
+}
+
+/**
+ * Allocate a segment of given size and attach it to the X server
+ */
+shm_segment::shm_segment(connection& conn, size_t size) : m_connection(conn) {
+  if ((m_shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600)) == -1) {
+    throw system_error("Failed to allocate shared memory segment");
+  }
+
+  auto data = shmat(m_shmid, nullptr, 0);
+
+  if (data == reinterpret_cast<void*>(-1)) {
+    shmctl(m_shmid, IPC_RMID, nullptr);
+    throw system_error("Failed to attach shared memory segment");
+  }
+
+  m_data = static_cast<unsigned char*>(data);
+  m_seg = m_connection.generate_id();
+
+  auto err = xcb_request_check(m_connection, xcb_shm_attach_checked(m_connection, m_seg, m_shmid, 0));
+
+  // The segment is released once both sides have detached
+  shmctl(m_shmid, IPC_RMID, nullptr);
+
+  if (err != nullptr) {
+    free(err);
+    shmdt(m_data);
+    throw application_error("X server failed to attach shared memory segment");
+  }
+}
+
+/**
+ * Detach the segment from the X server and the process
+ */
+shm_segment::~shm_segment() {
+  sync();
+  xcb_shm_detach(m_connection, m_seg);
+  shmdt(m_data);
+}
+
+/**
+ * Get pointer to the start of the segment
+ */
+unsigned char* shm_segment::data() const {
+  return m_data;
+}
+
+/**
+ * Copy given area of the image stored in the segment onto the drawable
+ *
+ * @note The segment must not be modified before calling `sync()`
+ */
+void shm_segment::put_image(xcb_drawable_t drawable, xcb_gcontext_t gc, uint16_t total_width,
+    uint16_t total_height, const xcb_rectangle_t& area, uint8_t depth) {
+  xcb_shm_put_image(m_connection, drawable, gc, total_width, total_height, area.x, area.y, area.width, area.height,
+      area.x, area.y, depth, XCB_IMAGE_FORMAT_Z_PIXMAP, 0, m_seg, 0);
+  m_pending = true;
+}
+
+/**
+ * Wait until the server has processed all pending image requests
+ */
+void shm_segment::sync() {
+  if (m_pending) {
+    free(xcb_get_input_focus_reply(m_connection, xcb_get_input_focus(m_connection), nullptr));
+    m_pending = false;
+  }
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,117 @@
+#include "components/builder.hpp"
+#include "components/parser.hpp"
+#include "components/types.hpp"
+
+int main() {
+  using namespace polybar;
+
+  bar_settings bar{};
+  bar.foreground = 0xFF123456;
+
+  "text"_test = [&] {
+    builder b{bar};
+    b.node("foo");
+    b.space(2);
+    b.node("\"bar%__baz\"");
+    auto output = b.flush();
+    expect(output.size() == 1);
+    expect(output[0].type == drawtype::TEXT && output[0].data == "foo  bar baz");
+  };
+
+  "colors"_test = [&] {
+    builder b{bar};
+    b.color("#f00");
+    b.node("a");
+    b.color_close();
+    b.color("#ff0000ff");
+    b.node("b");
+    auto output = b.flush();
+    expect(output.size() == 5);
+    expect(output[0].type == drawtype::FOREGROUND && output[0].color == 0xFFFF0000);
+    expect(output[1].type == drawtype::TEXT && output[1].data == "a");
+    // The reset is replaced by the color that follows it
+    expect(output[2].type == drawtype::FOREGROUND && output[2].color == 0xFF0000FF);
+    expect(output[3].type == drawtype::TEXT && output[3].data == "b");
+    expect(output[4].type == drawtype::FOREGROUND && output[4].color == bar.foreground);
+  };
+
+  "actions"_test = [&] {
+    builder b{bar};
+    b.cmd(mousebtn::LEFT, "foo:bar");
+    b.cmd(mousebtn::RIGHT, "baz");
+    b.node("x");
+    b.cmd_close();
+    auto output = b.flush();
+    expect(output.size() == 5);
+    expect(output[0].type == drawtype::ACTION_BEGIN && output[0].value == static_cast<int>(mousebtn::LEFT));
+    expect(output[0].data == "foo\\:bar");
+    expect(output[1].type == drawtype::ACTION_BEGIN && output[1].value == static_cast<int>(mousebtn::RIGHT));
+    expect(output[2].type == drawtype::TEXT && output[2].data == "x");
+    expect(output[3].type == drawtype::ACTION_END && output[3].value == static_cast<int>(mousebtn::RIGHT));
+    expect(output[4].type == drawtype::ACTION_END && output[4].value == static_cast<int>(mousebtn::LEFT));
+  };
+
+  "raw_markup"_test = [&] {
+    builder b{bar};
+    b.node("%{F#f00}a%{F-}%{A3:baz:}b%{A}%{O5}%{+u}c");
+    auto output = b.flush();
+    expect(output.size() == 10);
+    expect(output[0].type == drawtype::FOREGROUND && output[0].color == 0xFFFF0000);
+    expect(output[1].type == drawtype::TEXT && output[1].data == "a");
+    expect(output[2].type == drawtype::FOREGROUND && output[2].color == bar.foreground);
+    expect(output[3].type == drawtype::ACTION_BEGIN && output[3].value == static_cast<int>(mousebtn::RIGHT));
+    expect(output[3].data == "baz");
+    expect(output[4].type == drawtype::TEXT && output[4].data == "b");
+    expect(output[5].type == drawtype::ACTION_END && output[5].value == static_cast<int>(mousebtn::RIGHT));
+    expect(output[6].type == drawtype::OFFSET && output[6].value == 5);
+    expect(output[7].type == drawtype::ATTRIBUTE_SET && output[7].value == static_cast<int>(attribute::UNDERLINE));
+    expect(output[8].type == drawtype::TEXT && output[8].data == "c");
+    expect(output[9].type == drawtype::ATTRIBUTE_UNSET && output[9].value == static_cast<int>(attribute::UNDERLINE));
+  };
+
+  "invalid_markup"_test = [&] {
+    builder b{bar};
+    b.node("a%{Z}b");
+    auto output = b.flush();
+    expect(output.size() == 1);
+    expect(output[0].type == drawtype::TEXT && output[0].data == "ab");
+  };
+
+  "trailing_space"_test = [&] {
+    builder b{bar};
+    b.node("a");
+    b.space(3);
+    b.remove_trailing_space(3);
+    b.color("#f00");
+    b.space(2);
+    b.remove_trailing_space(2);
+    b.remove_trailing_space(1);
+    auto output = b.flush();
+    expect(output.size() == 2);
+    expect(output[0].type == drawtype::TEXT && output[0].data == "a");
+    expect(output[1].type == drawtype::FOREGROUND && output[1].color == bar.foreground);
+  };
+
+  "markup"_test = [&] {
+    builder b{bar};
+    b.font(2);
+    b.background("#0f0");
+    b.cmd(mousebtn::MIDDLE, "foo:bar");
+    b.node("x y");
+    b.offset(-3);
+    b.underline("#00f");
+    b.node("z");
+    auto output = b.flush();
+
+    display_list parsed;
+    parser::make()->parse(bar, builder::markup(bar, output), parsed);
+    expect(parsed == output);
+  };
+
+  "markup_defaults"_test = [&] {
+    builder b{bar};
+    b.color("#f00");
+    b.node("a");
+    expect(builder::markup(bar, b.flush()) == "%{F#ffff0000}a%{F-}");
+  };
+}
@@ -0,0 +1,73 @@
+#include <unistd.h>
+#include <fstream>
+
+#include "components/eventloop.cpp"
+#include "components/inotify_dispatcher.cpp"
+#include "components/logger.cpp"
+#include "utils/concurrency.cpp"
+#include "utils/inotify.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+
+  char path[]{"/tmp/polybar-inotify-XXXXXX"};
+  close(mkstemp(path));
+
+  const auto touch = [&] { std::ofstream(path) << "foo" << std::endl; };
+
+  auto& loop = eventloop::make();
+  auto& inotify = inotify_dispatcher::make();
+
+  const auto dispatch_until = [&](const function<bool()>& done) {
+    for (int i = 0; i < 10 && !done(); i++) {
+      loop.dispatch(100);
+    }
+  };
+
+  "notify"_test = [&] {
+    vector<string> files;
+    auto id = inotify.add(
+        path, IN_MODIFY, [&](const polybar::inotify_event& event) { files.emplace_back(event.filename); });
+
+    touch();
+    dispatch_until([&] { return !files.empty(); });
+    inotify.remove(id);
+
+    expect(!files.empty());
+    expect(files[0] == path);
+  };
+
+  "shared_watch"_test = [&] {
+    int first{0};
+    int second{0};
+    auto a = inotify.add(path, IN_MODIFY, [&](const polybar::inotify_event&) { first++; });
+    auto b = inotify.add(path, IN_CLOSE_WRITE, [&](const polybar::inotify_event&) { second++; });
+
+    touch();
+    dispatch_until([&] { return first > 0 && second > 0; });
+    expect(first > 0);
+    expect(second > 0);
+
+    // Removing one subscriber keeps the watch of the other
+    inotify.remove(a);
+    first = second = 0;
+    touch();
+    dispatch_until([&] { return second > 0; });
+    expect(first == 0);
+    expect(second > 0);
+
+    inotify.remove(b);
+  };
+
+  "remove"_test = [&] {
+    int count{0};
+    inotify.remove(inotify.add(path, IN_MODIFY, [&](const polybar::inotify_event&) { count++; }));
+
+    touch();
+    loop.dispatch(100);
+    expect(count == 0);
+  };
+
+  unlink(path);
+}
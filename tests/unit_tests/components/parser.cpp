@@ -0,0 +1,72 @@
+#include "components/parser.cpp"
+#include "components/types.hpp"
+
+int main() {
+  using namespace polybar;
+
+  const auto parse = [](const string& data) {
+    bar_settings bar{};
+    display_list output;
+    parser::make()->parse(bar, data, output);
+    return output;
+  };
+
+  "text"_test = [&] {
+    auto output = parse("foo bar");
+    expect(output.size() == 1);
+    expect(output[0].type == drawtype::TEXT);
+    expect(output[0].data == "foo bar");
+  };
+
+  "tags"_test = [&] {
+    auto output = parse("%{l}a%{B#f00 F#ff00ff00 T2}b%{O-3 +u}c%{B- -u}");
+    expect(output.size() == 11);
+    expect(output[0].type == drawtype::ALIGNMENT && output[0].value == static_cast<int>(alignment::LEFT));
+    expect(output[1].type == drawtype::TEXT && output[1].data == "a");
+    expect(output[2].type == drawtype::BACKGROUND && output[2].color == 0xFFFF0000);
+    expect(output[3].type == drawtype::FOREGROUND && output[3].color == 0xFF00FF00);
+    expect(output[4].type == drawtype::FONT && output[4].value == 2);
+    expect(output[5].type == drawtype::TEXT && output[5].data == "b");
+    expect(output[6].type == drawtype::OFFSET && output[6].value == -3);
+    expect(output[7].type == drawtype::ATTRIBUTE_SET && output[7].value == static_cast<int>(attribute::UNDERLINE));
+    expect(output[8].type == drawtype::TEXT && output[8].data == "c");
+    expect(output[9].type == drawtype::BACKGROUND && output[9].color == 0);
+    expect(output[10].type == drawtype::ATTRIBUTE_UNSET);
+  };
+
+  "actions"_test = [&] {
+    auto output = parse("%{A:foo\\:bar:}%{A3:baz:}x%{A}%{A}");
+    expect(output.size() == 5);
+    expect(output[0].type == drawtype::ACTION_BEGIN && output[0].value == static_cast<int>(mousebtn::LEFT));
+    expect(output[0].data == "foo\\:bar");
+    expect(output[1].type == drawtype::ACTION_BEGIN && output[1].value == static_cast<int>(mousebtn::RIGHT));
+    expect(output[1].data == "baz");
+    expect(output[2].type == drawtype::TEXT && output[2].data == "x");
+    expect(output[3].type == drawtype::ACTION_END && output[3].value == static_cast<int>(mousebtn::RIGHT));
+    expect(output[4].type == drawtype::ACTION_END && output[4].value == static_cast<int>(mousebtn::LEFT));
+  };
+
+  "unclosed"_test = [&] {
+    auto output = parse("%{F#fff");
+    expect(output.size() == 1);
+    expect(output[0].type == drawtype::TEXT && output[0].data == "%{F#fff");
+
+    bool thrown{false};
+    try {
+      parse("%{A:foo:}bar");
+    } catch (const unclosed_actionblocks&) {
+      thrown = true;
+    }
+    expect(thrown);
+  };
+
+  "invalid"_test = [&] {
+    bool thrown{false};
+    try {
+      parse("%{Q}");
+    } catch (const unrecognized_token&) {
+      thrown = true;
+    }
+    expect(thrown);
+  };
+}
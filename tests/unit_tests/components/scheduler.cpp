@@ -0,0 +1,124 @@
+#include <condition_variable>
+
+#include "components/logger.cpp"
+#include "components/scheduler.cpp"
+#include "utils/concurrency.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+
+  const auto wait_for = [](std::mutex& lock, std::condition_variable& cond, const function<bool()>& done) {
+    std::unique_lock<std::mutex> guard(lock);
+    return cond.wait_for(guard, 5s, done);
+  };
+
+  "delay"_test = [&] {
+    scheduler sched(logger::make(), 1);
+    std::mutex lock;
+    std::condition_variable cond;
+    bool fired{false};
+
+    auto id = sched.add([&] {
+      std::lock_guard<std::mutex> guard(lock);
+      fired = true;
+      cond.notify_all();
+    });
+
+    // Arm in the middle of a tick
+    std::this_thread::sleep_for(scheduler::TICK * 3 + 7ms);
+
+    auto start = chrono::steady_clock::now();
+    sched.arm(id, 50ms);
+    expect(wait_for(lock, cond, [&] { return fired; }));
+    expect(chrono::steady_clock::now() - start >= 50ms);
+  };
+
+  "order"_test = [&] {
+    scheduler sched(logger::make(), 1);
+    std::mutex lock;
+    std::condition_variable cond;
+    vector<int> fired;
+
+    // Spread over several levels of the wheel
+    for (int delay : {800, 30, 0, 150, 700}) {
+      sched.arm(sched.add([&, delay] {
+        std::lock_guard<std::mutex> guard(lock);
+        fired.emplace_back(delay);
+        cond.notify_all();
+      }), chrono::milliseconds{delay});
+    }
+
+    expect(wait_for(lock, cond, [&] { return fired.size() == 5; }));
+    expect(fired == vector<int>{0, 30, 150, 700, 800});
+  };
+
+  "rearm"_test = [&] {
+    scheduler sched(logger::make(), 1);
+    std::mutex lock;
+    std::condition_variable cond;
+    int count{0};
+
+    auto id = sched.add([&] {
+      std::lock_guard<std::mutex> guard(lock);
+      count++;
+      cond.notify_all();
+    });
+
+    sched.arm(id, 1h);
+    sched.arm(id, 20ms);
+    expect(wait_for(lock, cond, [&] { return count == 1; }));
+    std::this_thread::sleep_for(50ms);
+    expect(count == 1);
+  };
+
+  "no_overlap"_test = [&] {
+    scheduler sched(logger::make(), 4);
+    std::mutex lock;
+    std::condition_variable cond;
+    std::atomic<int> active{0};
+    int count{0};
+    bool overlap{false};
+    scheduler::timer_id id{0};
+
+    id = sched.add([&] {
+      overlap = overlap || active++ > 0;
+      sched.arm(id, 0ms);
+      std::this_thread::sleep_for(5ms);
+      active--;
+
+      std::lock_guard<std::mutex> guard(lock);
+      if (++count == 10) {
+        sched.remove(id);
+      }
+      cond.notify_all();
+    });
+
+    sched.arm(id, 0ms);
+    expect(wait_for(lock, cond, [&] { return count == 10; }));
+    expect(!overlap);
+  };
+
+  "remove_waits"_test = [&] {
+    scheduler sched(logger::make(), 1);
+    std::mutex lock;
+    std::condition_variable cond;
+    bool started{false};
+    bool finished{false};
+
+    auto id = sched.add([&] {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        started = true;
+        cond.notify_all();
+      }
+      std::this_thread::sleep_for(50ms);
+      finished = true;
+    });
+
+    sched.arm(id, 0ms);
+    expect(wait_for(lock, cond, [&] { return started; }));
+    sched.remove(id);
+    expect(finished);
+  };
+}
@@ -0,0 +1,64 @@
+#include <condition_variable>
+
+#include "components/eventloop.cpp"
+#include "components/logger.cpp"
+#include "components/reaper.cpp"
+#include "components/spawner.cpp"
+#include "utils/command.cpp"
+#include "utils/concurrency.cpp"
+#include "utils/env.cpp"
+#include "utils/file.cpp"
+#include "utils/io.cpp"
+#include "utils/process.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "exit_status"_test = [] {
+    std::mutex lock;
+    std::condition_variable cond;
+    vector<int> statuses;
+
+    {
+      auto s = spawner::make(2);
+      const auto done = [&](const string&, int status) {
+        std::lock_guard<std::mutex> guard(lock);
+        statuses.emplace_back(status);
+        cond.notify_one();
+      };
+      s->spawn("exit 0", done);
+      s->spawn("exit 3", done);
+
+      std::unique_lock<std::mutex> guard(lock);
+      cond.wait(guard, [&] { return statuses.size() == 2; });
+    }
+
+    std::sort(statuses.begin(), statuses.end());
+    expect(statuses[0] == 0);
+    expect(statuses[1] == 3);
+  };
+
+  "serialized"_test = [] {
+    std::mutex lock;
+    std::condition_variable cond;
+    vector<string> order;
+
+    {
+      auto s = spawner::make(4);
+      const auto done = [&](const string& cmd, int) {
+        std::lock_guard<std::mutex> guard(lock);
+        order.emplace_back(cmd);
+        cond.notify_one();
+      };
+      s->spawn("sleep 0.2; echo a", done, "key");
+      s->spawn("echo b", done, "key");
+
+      std::unique_lock<std::mutex> guard(lock);
+      cond.wait(guard, [&] { return order.size() == 2; });
+    }
+
+    expect(order[0] == "sleep 0.2; echo a");
+    expect(order[1] == "echo b");
+  };
+}
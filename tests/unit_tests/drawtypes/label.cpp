@@ -0,0 +1,73 @@
+#include "drawtypes/label.hpp"
+
+int main() {
+  using namespace polybar;
+  using namespace drawtypes;
+
+  const auto make = [](string text, vector<token>&& tokens) {
+    return make_shared<label>(
+        text, ""s, ""s, ""s, ""s, 0, side_values{0U, 0U}, side_values{0U, 0U}, 0_z, true, move(tokens));
+  };
+
+  "replace"_test = [&] {
+    auto l = make("%a% and %b% and %a%", {token{"%a%"}, token{"%b%"}, token{"%a%"}});
+    l->replace_token("%a%", "foo");
+    expect(l->get() == "foo and %b% and foo");
+    l->replace_token("%b%", "bar");
+    expect(l->get() == "foo and bar and foo");
+  };
+
+  "repeated_token"_test = [&] {
+    auto l = make("%a%%a%", {token{"%a%"}});
+    l->replace_token("%a%", "x");
+    expect(l->get() == "xx");
+    expect(!l->has_token("%a%"));
+  };
+
+  "first_replacement"_test = [&] {
+    auto l = make("%a%", {token{"%a%"}});
+    l->replace_token("%a%", "foo");
+    l->replace_token("%a%", "bar");
+    expect(l->get() == "foo");
+  };
+
+  "reset"_test = [&] {
+    auto l = make("<%a%>", {token{"%a%"}});
+    l->replace_token("%a%", "foo");
+    l->reset_tokens();
+    expect(l->get() == "<%a%>");
+    l->replace_token("%a%", "bar");
+    expect(l->get() == "<bar>");
+  };
+
+  "min_max"_test = [&] {
+    auto l = make("%a%|%b%", {token{"%a%", 3_z, 0_z}, token{"%b%", 0_z, 3_z, "..."}});
+    l->replace_token("%a%", "1");
+    l->replace_token("%b%", "foobar");
+    expect(l->get() == "  1|foo...");
+  };
+
+  "reset_tokenized"_test = [&] {
+    auto l = make("%a%", {token{"%a%"}});
+    l->reset_tokens("%a% %a%");
+    l->replace_token("%a%", "foo");
+    expect(l->get() == "foo foo");
+    l->reset_tokens();
+    expect(l->get() == "%a%");
+  };
+
+  "clear"_test = [&] {
+    auto l = make("%a%", {token{"%a%"}});
+    l->clear();
+    l->replace_token("%a%", "foo");
+    expect(!*l);
+    l->reset_tokens();
+    expect(l->has_token("%a%"));
+  };
+
+  "untokenized"_test = [&] {
+    label l{"%a%", 0};
+    l.replace_token("%a%", "foo");
+    expect(l.get() == "%a%");
+  };
+}
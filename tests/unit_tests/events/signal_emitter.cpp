@@ -0,0 +1,131 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "events/signal_emitter.hpp"
+
+using namespace polybar;
+
+namespace {
+  struct ping {};
+
+  class receiver : public signal_receiver<0, ping> {
+   public:
+    explicit receiver(function<void(receiver*)> handler = nullptr) : m_handler(move(handler)) {}
+
+    bool on(const ping&) {
+      if (!alive) {
+        called_after_detach = true;
+      }
+      calls++;
+      if (m_handler) {
+        m_handler(this);
+      }
+      return false;
+    }
+
+    std::atomic<bool> alive{true};
+    std::atomic<bool> called_after_detach{false};
+    std::atomic<int> calls{0};
+
+   private:
+    function<void(receiver*)> m_handler;
+  };
+}
+
+int main() {
+  using namespace std::chrono_literals;
+
+  "detach_waits_for_emit"_test = [] {
+    signal_emitter emitter;
+    std::atomic<bool> entered{false};
+    receiver r{[&](receiver* self) {
+      entered = true;
+      std::this_thread::sleep_for(50ms);
+      expect(self->alive);
+    }};
+
+    emitter.attach(&r);
+    std::thread t([&] { emitter.emit(ping{}); });
+    while (!entered) {
+      std::this_thread::yield();
+    }
+
+    emitter.detach(&r);
+    r.alive = false;
+    t.join();
+
+    emitter.emit(ping{});
+    expect(r.calls == 1);
+    expect(!r.called_after_detach);
+  };
+
+  "detach_from_handler"_test = [] {
+    signal_emitter emitter;
+    receiver r{[&](receiver* self) { emitter.detach(self); }};
+
+    emitter.attach(&r);
+    emitter.emit(ping{});
+    emitter.emit(ping{});
+    expect(r.calls == 1);
+  };
+
+  "concurrent_detach_from_handlers"_test = [] {
+    signal_emitter emitter;
+    std::atomic<int> waiting{0};
+    const auto handler = [&](receiver* self) {
+      // Both handlers run before either detaches
+      waiting++;
+      while (waiting < 2) {
+        std::this_thread::yield();
+      }
+      emitter.detach(self);
+    };
+    receiver a{handler};
+    receiver b{handler};
+
+    emitter.attach(&a);
+    emitter.attach(&b);
+    std::thread t1([&] { emitter.emit(ping{}); });
+    std::thread t2([&] { emitter.emit(ping{}); });
+    t1.join();
+    t2.join();
+
+    emitter.emit(ping{});
+    expect(a.calls == 2);
+    expect(b.calls == 2);
+  };
+
+  "detach_during_emits"_test = [] {
+    signal_emitter emitter;
+    std::atomic<bool> stop{false};
+    receiver anchor;
+    emitter.attach(&anchor);
+
+    vector<std::thread> emitters;
+    for (int i = 0; i < 4; i++) {
+      emitters.emplace_back([&] {
+        while (!stop) {
+          emitter.emit(ping{});
+        }
+      });
+    }
+
+    // Emits keep starting while receivers come and go
+    for (int i = 0; i < 200; i++) {
+      receiver r;
+      emitter.attach(&r);
+      std::this_thread::yield();
+      emitter.detach(&r);
+      r.alive = false;
+      expect(!r.called_after_detach);
+    }
+
+    stop = true;
+    for (auto&& t : emitters) {
+      t.join();
+    }
+    emitter.detach(&anchor);
+    expect(anchor.calls > 0);
+  };
+}
@@ -0,0 +1,64 @@
+#include "modules/meta/base.hpp"
+
+int main() {
+  using namespace polybar;
+  using namespace modules;
+
+  const auto compile = [](string value) {
+    module_format format;
+    format.value = move(value);
+    format.tags = {{"<label>", 0}, {"<bar>", 1}};
+    format.compile();
+    return format.segments;
+  };
+
+  "literal"_test = [&] {
+    auto segments = compile("foo bar");
+    expect(segments.size() == 1);
+    expect(segments[0].text == "foo bar");
+    expect(segments[0].tag == module_format::LITERAL);
+  };
+
+  "tags"_test = [&] {
+    auto segments = compile("<bar> <label>");
+    expect(segments.size() == 3);
+    expect(segments[0].tag == 1);
+    expect(segments[1].text == " " && segments[1].tag == module_format::LITERAL);
+    expect(segments[2].text == "<label>" && segments[2].tag == 0);
+  };
+
+  "trailing_text"_test = [&] {
+    auto segments = compile("x<label>%");
+    expect(segments.size() == 3);
+    expect(segments[0].text == "x" && segments[0].tag == module_format::LITERAL);
+    expect(segments[1].tag == 0);
+    expect(segments[2].text == "%" && segments[2].tag == module_format::LITERAL);
+  };
+
+  "unclosed_tag"_test = [&] {
+    auto segments = compile("<label> <bar");
+    expect(segments.size() == 2);
+    expect(segments[1].text == " <bar" && segments[1].tag == module_format::LITERAL);
+  };
+
+  "recompile"_test = [&] {
+    module_format format;
+    format.tags = {{"<label>", 0}};
+    format.value = "a<label>";
+    format.compile();
+    format.value = "<label>";
+    format.compile();
+    expect(format.segments.size() == 1);
+    expect(format.segments[0].tag == 0);
+  };
+
+  "unknown_tag"_test = [&] {
+    bool thrown{false};
+    try {
+      compile("<label> <ramp>");
+    } catch (const undefined_format_tag&) {
+      thrown = true;
+    }
+    expect(thrown);
+  };
+}
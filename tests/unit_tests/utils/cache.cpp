@@ -0,0 +1,50 @@
+#include "utils/cache.hpp"
+
+int main() {
+  using namespace polybar;
+
+  "lru_find"_test = [] {
+    lru_cache<string, int> c{2};
+    expect(c.find("foo") == nullptr);
+    c.insert("foo", 1);
+    expect(c.find("foo") != nullptr);
+    expect(*c.find("foo") == 1);
+    expect(c.hits() == 2);
+    expect(c.misses() == 1);
+  };
+
+  "lru_evict"_test = [] {
+    lru_cache<string, int> c{2};
+    c.insert("foo", 1);
+    c.insert("bar", 2);
+    c.find("foo");
+    c.insert("baz", 3);
+    expect(c.size() == 2);
+    expect(c.find("bar") == nullptr);
+    expect(c.find("foo") != nullptr);
+    expect(c.find("baz") != nullptr);
+  };
+
+  "lru_replace"_test = [] {
+    lru_cache<string, int> c{2};
+    c.insert("foo", 1);
+    c.insert("foo", 2);
+    expect(c.size() == 1);
+    expect(*c.find("foo") == 2);
+    c.clear();
+    expect(c.size() == 0);
+    expect(c.find("foo") == nullptr);
+  };
+
+  "lru_disabled"_test = [] {
+    lru_cache<string, int> c{0};
+    expect(c.insert("foo", 1) == 1);
+    expect(c.find("foo") == nullptr);
+    expect(c.insert("bar", 2) == 2);
+    expect(c.insert("baz", 3) == 3);
+    expect(c.size() == 1);
+    expect(c.find("baz") == nullptr);
+    expect(c.hits() == 0);
+    expect(c.misses() == 2);
+  };
+}
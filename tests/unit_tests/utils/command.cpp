@@ -0,0 +1,77 @@
+#include "utils/command.cpp"
+#include "components/eventloop.cpp"
+#include "components/logger.cpp"
+#include "components/reaper.cpp"
+#include "utils/concurrency.cpp"
+#include "utils/env.cpp"
+#include "utils/file.cpp"
+#include "utils/io.cpp"
+#include "utils/process.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "exit_status"_test = [] {
+    expect(WEXITSTATUS(command_util::make_command("exit 0")->exec()) == 0);
+    expect(WEXITSTATUS(command_util::make_command("exit 4")->exec()) == 4);
+  };
+
+  "output"_test = [] {
+    // Each readline() buffers on its own, so keep everything on one line
+    auto cmd = command_util::make_command("printf foo; echo bar >&2");
+    cmd->exec(false);
+    expect(cmd->readline() == "foobar");
+    cmd->wait();
+  };
+
+  "input"_test = [] {
+    auto cmd = command_util::make_command("read -r line; echo \"got $line\"");
+    cmd->exec(false);
+    cmd->writeline("baz");
+    expect(cmd->readline() == "got baz");
+    cmd->wait();
+  };
+
+  "process_group"_test = [] {
+    auto cmd = command_util::make_command("cut -d' ' -f5 /proc/$$/stat");
+    cmd->exec(false);
+    expect(std::stoi(cmd->readline()) == cmd->get_pid());
+    cmd->wait();
+  };
+
+  "exit_notification"_test = [] {
+    auto cmd = command_util::make_command("exit 3");
+    cmd->exec(false);
+    while (cmd->is_running()) {
+      eventloop::make().dispatch(1000);
+    }
+    expect(WEXITSTATUS(cmd->get_exit_status()) == 3);
+  };
+
+  "terminate"_test = [] {
+    auto cmd = command_util::make_command("sleep 10");
+    cmd->exec(false);
+    cmd->terminate();
+    expect(!cmd->is_running());
+    expect(WIFSIGNALED(cmd->get_exit_status()) && WTERMSIG(cmd->get_exit_status()) == SIGTERM);
+  };
+
+  "terminate_ignored"_test = [] {
+    auto cmd = command_util::make_command("trap '' TERM; echo ready; while :; do sleep 0.05; done");
+    cmd->exec(false);
+    expect(cmd->readline() == "ready");
+    auto start = std::chrono::steady_clock::now();
+    cmd->terminate(std::chrono::milliseconds{100});
+    expect(!cmd->is_running());
+    expect(WIFSIGNALED(cmd->get_exit_status()) && WTERMSIG(cmd->get_exit_status()) == SIGKILL);
+    expect(std::chrono::steady_clock::now() - start < std::chrono::seconds{2});
+  };
+
+  "wait_after_exit"_test = [] {
+    auto cmd = command_util::make_command("exit 5");
+    cmd->exec(false);
+    expect(WEXITSTATUS(cmd->wait()) == 5);
+    expect(!cmd->is_running());
+  };
+}
@@ -0,0 +1,57 @@
+#include "utils/concurrency.hpp"
+
+int main() {
+  using namespace polybar;
+
+  "mailbox_latest"_test = [] {
+    mailbox<int> box;
+    int value{0};
+    expect(!box.post(1));
+    expect(box.post(2));
+    expect(box.wait(value));
+    expect(value == 2);
+    expect(!box.post(3));
+    expect(box.wait(value));
+    expect(value == 3);
+  };
+
+  "mailbox_merge"_test = [] {
+    mailbox<int> box;
+    int value{0};
+    const auto merge = [](int& pending, int& next) { next += pending; };
+    expect(!box.post(1, merge));
+    expect(box.post(2, merge));
+    expect(box.wait(value));
+    expect(value == 3);
+    expect(!box.post(4, merge));
+    expect(box.wait(value));
+    expect(value == 4);
+  };
+
+  "mailbox_close"_test = [] {
+    mailbox<string> box;
+    string value;
+    box.post("foo");
+    box.close();
+    expect(box.wait(value));
+    expect(value == "foo");
+    expect(!box.wait(value));
+  };
+
+  "mailbox_thread"_test = [] {
+    mailbox<int> box;
+    int sum{0};
+    thread consumer([&] {
+      int value{0};
+      while (box.wait(value)) {
+        sum = value;
+      }
+    });
+    for (int i = 1; i <= 1000; i++) {
+      box.post(i);
+    }
+    box.close();
+    consumer.join();
+    expect(sum == 1000);
+  };
+}